@@ -56,6 +56,7 @@
 #include "eclass.h"
 #include "sql.h"
 #include "workdb.h"
+#include "memstat.h"
 
 // Function currently being parsed
 Call *Call::current_fun = NULL;
@@ -72,6 +73,10 @@ int Call::macro_nesting;
 // All known macros
 map<Call::name_identifier, Call *> Call::macros;
 
+// Epochs of the visited and printed flags; functions start at 0
+unsigned Call::current_visit_epoch = 1;
+unsigned Call::current_print_epoch = 1;
+
 // The current function makes a call to f
 void
 Call::register_call(Call *f)
@@ -128,6 +133,9 @@ Call::register_call(Call *from, Call *to)
 // ctor; never call it if the call for t already exists
 Call::Call(const string &s, const Token &t) :
 		name(s),
+		visited(0),
+		visit_epoch(0),
+		print_epoch(0),
 		pre_cpp_metrics(this),
 		post_cpp_metrics(this),
 		curr_stmt_nesting(0),
@@ -168,18 +176,27 @@ populate_namers()
 	}
 }
 
+// Clear the visit flags for all functions by starting a new epoch
 void
 Call::clear_visit_flags()
 {
+	if (++current_visit_epoch != 0)
+		return;
+	// Wrapped around; reset the stale epochs
 	for (const_fmap_iterator_type i = all.begin(); i != all.end(); i++)
-		i->second->visited = false;
+		i->second->visit_epoch = 0;
+	current_visit_epoch = 1;
 }
 
+// Clear the print flags for all functions by starting a new epoch
 void
 Call::clear_print_flags()
 {
+	if (++current_print_epoch != 0)
+		return;
 	for (const_fmap_iterator_type i = all.begin(); i != all.end(); i++)
-		i->second->printed = false;
+		i->second->print_epoch = 0;
+	current_print_epoch = 1;
 }
 
 // Get a call site for a given Token
@@ -275,50 +292,54 @@ Call::dumpSql(Sql *db, ostream &of)
 	for (const_fmap_iterator_type i = fbegin(); i != fend(); i++) {
 		Call *fun = i->second;
 		Tokid t = fun->get_site();
-		if (table_is_enabled(t_functions))
-			of << "INSERT INTO FUNCTIONS VALUES("
-			    << ptr_offset(fun) << ", '"
-			    << fun->name << "', "
-			    << db->boolval(fun->is_macro()) << ','
-			    << db->boolval(fun->is_defined()) << ','
-			    << db->boolval(fun->is_declared()) << ','
-			    << db->boolval(fun->is_file_scoped()) << ','
-			    << t.get_fileid().get_id() << ','
-			    << (unsigned)(t.get_streampos()) << ','
-			    << fun->get_num_caller()
-			    << ");\n";
+		if (table_is_enabled(t_functions)) {
+			db->begin_row(of, "FUNCTIONS");
+			db->int_value(of, ptr_offset(fun));
+			db->string_value(of, fun->name);
+			db->bool_value(of, fun->is_macro());
+			db->bool_value(of, fun->is_defined());
+			db->bool_value(of, fun->is_declared());
+			db->bool_value(of, fun->is_file_scoped());
+			db->int_value(of, t.get_fileid().get_id());
+			db->int_value(of, (unsigned)(t.get_streampos()));
+			db->int_value(of, fun->get_num_caller());
+			db->end_row(of);
+		}
 
 		if (fun->is_defined() && table_is_enabled(t_functiondefs)) {
-			of << "INSERT INTO FUNCTIONDEFS VALUES(" << ptr_offset(fun)
-			    << ',' << fun->get_begin().get_tokid().get_fileid().get_id() <<
-			    ',' << (unsigned)(fun->get_begin().get_tokid().get_streampos()) <<
-			    ',' << fun->get_end().get_tokid().get_fileid().get_id() <<
-			    ',' << (unsigned)(fun->get_end().get_tokid().get_streampos());
-			of << ");\n";
+			db->begin_row(of, "FUNCTIONDEFS");
+			db->int_value(of, ptr_offset(fun));
+			db->int_value(of, fun->get_begin().get_tokid().get_fileid().get_id());
+			db->int_value(of, (unsigned)(fun->get_begin().get_tokid().get_streampos()));
+			db->int_value(of, fun->get_end().get_tokid().get_fileid().get_id());
+			db->int_value(of, (unsigned)(fun->get_end().get_tokid().get_streampos()));
+			db->end_row(of);
 		}
 		if (fun->is_defined() && table_is_enabled(t_functionmetrics)) {
-			of << "INSERT INTO FUNCTIONMETRICS VALUES("
-			    << ptr_offset(fun) << ',' << db->boolval(true);
+			db->begin_row(of, "FUNCTIONMETRICS");
+			db->int_value(of, ptr_offset(fun));
+			db->bool_value(of, true);
 			for (int j = 0; j < FunMetrics::metric_max; j++) {
 				if (Metrics::is_internal<FunMetrics>(j))
 					continue;
 				if (Metrics::is_pre_cpp<FunMetrics>(j))
-					of << ',' << fun->get_pre_cpp_metrics().get_metric(j);
+					db->real_value(of, fun->get_pre_cpp_metrics().get_metric(j));
 				else
-					of << ",NULL";
+					db->null_value(of);
 			}
-			of << ");\n";
-			of << "INSERT INTO FUNCTIONMETRICS VALUES("
-			    << ptr_offset(fun) << ',' << db->boolval(false);
+			db->end_row(of);
+			db->begin_row(of, "FUNCTIONMETRICS");
+			db->int_value(of, ptr_offset(fun));
+			db->bool_value(of, false);
 			for (int j = 0; j < FunMetrics::metric_max; j++) {
 				if (Metrics::is_internal<FunMetrics>(j))
 					continue;
 				if (Metrics::is_post_cpp<FunMetrics>(j))
-					of << ',' << fun->get_post_cpp_metrics().get_metric(j);
+					db->real_value(of, fun->get_post_cpp_metrics().get_metric(j));
 				else
-					of << ",NULL";
+					db->null_value(of);
 			}
-			of << ");\n";
+			db->end_row(of);
 		}
 
 		if (table_is_enabled(t_functionid)) {
@@ -328,13 +349,13 @@ Call::dumpSql(Sql *db, ostream &of)
 
 				Eclass *ec = ti.get_ec();
 				int len = ec->get_len();
-				of << "INSERT INTO FUNCTIONID VALUES("
-				    << ptr_offset(fun) << ','
-				    << ord++ << ','
-				    << ti.get_fileid().get_id() << ','
-				    << (unsigned)(ti.get_streampos()) << ','
-				    << len
-				    << ");\n";
+				db->begin_row(of, "FUNCTIONID");
+				db->int_value(of, ptr_offset(fun));
+				db->int_value(of, ord++);
+				db->int_value(of, ti.get_fileid().get_id());
+				db->int_value(of, (unsigned)(ti.get_streampos()));
+				db->int_value(of, len);
+				db->end_row(of);
 			}
 		}
 	}
@@ -343,10 +364,12 @@ Call::dumpSql(Sql *db, ostream &of)
 	if (table_is_enabled(t_fcalls))
 		for (const_fmap_iterator_type i = fbegin(); i != fend(); i++) {
 			Call *fun = i->second;
-			for (Call::const_fiterator_type dest = fun->call_begin(); dest != fun->call_end(); dest++)
-				of << "INSERT INTO FCALLS VALUES(" <<
-				    ptr_offset(fun) << ',' <<
-				    ptr_offset(*dest) << ");\n";
+			for (Call::const_fiterator_type dest = fun->call_begin(); dest != fun->call_end(); dest++) {
+				db->begin_row(of, "FCALLS");
+				db->int_value(of, ptr_offset(fun));
+				db->int_value(of, ptr_offset(*dest));
+				db->end_row(of);
+			}
 		}
 }
 
@@ -371,3 +394,27 @@ Call::populate_macro_map()
 		macros.emplace(name, f);
 	}
 }
+
+void
+Call::memory_stats(MemoryStats &s)
+{
+	size_t bytes = node_bytes(all), edges = 0, edge_bytes = 0;
+	for (const fun_map::value_type &f : all) {
+		bytes += sizeof(Call) + string_bytes(f.second->name);
+		edges += f.second->call.size() + f.second->caller.size();
+		edge_bytes += node_bytes(f.second->call) + node_bytes(f.second->caller);
+	}
+	s.add("Functions and macros", all.size(), bytes);
+	s.add("Call graph edges", edges, edge_bytes);
+	s.add("Macro call map", macros.size(), node_bytes(macros));
+}
+
+void
+Call::freeze()
+{
+	all.freeze();
+	for (const fun_map::value_type &f : all) {
+		f.second->call.freeze();
+		f.second->caller.freeze();
+	}
+}
@@ -29,12 +29,14 @@
 #include "fchar.h"
 #include "token.h"
 #include "filedetails.h"
+#include "freezable.h"
 
 class FCall;
 class Sql;
 class Id;
 class Ctoken;
 class Pltoken;
+class MemoryStats;
 
 /*
  * Generic call information of a called/calling entity.
@@ -64,7 +66,7 @@ public:
 private:
 
 	// Container for storing called and calling functions
-	typedef set <Call *> fun_container;
+	typedef FreezableSet <Call *> fun_container;
 	/*
 	 * When processing the program, a Call * is stored with each Id.
 	 * This allows accurate lookup of calls within a linkage unit
@@ -107,14 +109,22 @@ private:
 	 *
 	 * (All references to Linux are for v6.14.2)
 	 */
-	typedef multimap <Tokid, Call *> fun_map;
+	typedef FreezableMultimap <Tokid, Call *> fun_map;
 
 
 	string name;			// Function's name
 	fun_container call;		// Functions this function calls
 	fun_container caller;		// Functions that call this function
+	/*
+	 * The visited and printed flags are only valid when their epoch
+	 * matches the current one, so that clearing them for all
+	 * functions only requires advancing the current epoch.
+	 */
 	unsigned char visited;		// For calculating transitive closures (bit mask or boolean)
-	bool printed;			// For printing a graph's nodes
+	unsigned visit_epoch;		// Traversal during which visited was set
+	unsigned print_epoch;		// Graph for which the function was printed
+	static unsigned current_visit_epoch;
+	static unsigned current_print_epoch;
 	FcharContext begin, end;	// Span of definition
 	FunMetrics pre_cpp_metrics;	// Metrics for this function, before cpp
 	FunMetrics post_cpp_metrics;	// Metrics for this function, after cpp
@@ -174,6 +184,10 @@ public:
 
 	// Dump the data in SQL format
 	static void dumpSql(Sql *db, ostream &of);
+	// Add the memory used by the functions and the call graph to s
+	static void memory_stats(MemoryStats &s);
+	// Compact the function map and the call graph
+	static void freeze();
 
 	// Populate a map from ECs to macros
 	static void populate_macro_map();
@@ -197,14 +211,19 @@ public:
 	int get_num_call() const { return call.size(); }
 	int get_num_caller() const { return caller.size(); }
 
-	void set_visited() { visited = true; }
+	void set_visited() { set_visited(1); }
 	// Bit-or the specified visit flag
-	void set_visited(unsigned char v) { visited  = v; }
-	bool is_visited() const { return (bool)visited; }
-	bool is_visited(unsigned short visit_id) const { return (bool)(visited & visit_id); }
-	unsigned char get_visited() const { return visited; }
-	void set_printed() { printed = true; }
-	bool is_printed() const { return printed; }
+	void set_visited(unsigned char v) {
+		visited = get_visited() | v;
+		visit_epoch = current_visit_epoch;
+	}
+	bool is_visited() const { return (bool)get_visited(); }
+	bool is_visited(unsigned short visit_id) const { return (bool)(get_visited() & visit_id); }
+	unsigned char get_visited() const {
+		return visit_epoch == current_visit_epoch ? visited : 0;
+	}
+	void set_printed() { print_epoch = current_print_epoch; }
+	bool is_printed() const { return print_epoch == current_print_epoch; }
 
 	// Mark the function's span
 	void mark_begin();
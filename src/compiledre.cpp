@@ -0,0 +1,144 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Literal analysis and matching of compiled regular expressions
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+
+#include "compiledre.h"
+#include "trigram.h"
+
+/*
+ * Set lit to the string matched by the extended RE re, if re is
+ * a non-empty literal, optionally anchored at its beginning or end.
+ * Return false if re is not such a literal.
+ */
+static bool
+re_literal(const string &re, string &lit, bool &anchor_begin, bool &anchor_end)
+{
+	size_t b = 0, e = re.length();
+	anchor_begin = anchor_end = false;
+	if (b < e && re[b] == '^') {
+		anchor_begin = true;
+		b++;
+	}
+	// A trailing $ is an anchor, unless it is escaped
+	if (e > b && re[e - 1] == '$') {
+		size_t nesc = 0;
+		for (size_t i = e - 1; i > b && re[i - 1] == '\\'; i--)
+			nesc++;
+		if (nesc % 2 == 0) {
+			anchor_end = true;
+			e--;
+		}
+	}
+	lit.clear();
+	for (size_t i = b; i < e; i++) {
+		char c = re[i];
+		if (c == '\\') {
+			if (++i == e)
+				return false;
+			c = re[i];
+			// Back-references and GNU extensions
+			if (isalnum((unsigned char)c) || c == '<' || c == '>' ||
+			    c == '`' || c == '\'')
+				return false;
+		} else if (strchr(".[]()*+?{}|^$", c))
+			return false;
+		lit += c;
+	}
+	return !lit.empty();
+}
+
+static string
+to_lower(string s)
+{
+	for (char &c : s)
+		c = tolower((unsigned char)c);
+	return s;
+}
+
+CompiledRE::Body::Body(const char *s, int flags) :
+	is_literal(false),
+	anchor_begin(false),
+	anchor_end(false),
+	icase(flags & REG_ICASE)
+{
+	// With REG_NEWLINE anchors also match around newlines
+	if (!(flags & REG_EXTENDED) || (flags & REG_NEWLINE))
+		return;
+
+	string lit;
+	bool begin, end;
+	if (re_literal(s, lit, begin, end)) {
+		is_literal = true;
+		literal = lit;
+		anchor_begin = begin;
+		anchor_end = end;
+	} else {
+		/*
+		 * Prefilter through the longest required literal.
+		 * Its position in the matched string is not known,
+		 * so it is searched for without anchors.
+		 */
+		vector <string> lits;
+		if (re_required_literals(s, lits))
+			for (const string &l : lits)
+				if (l.length() > literal.length())
+					literal = l;
+	}
+	if (icase)
+		literal = to_lower(literal);
+}
+
+bool
+CompiledRE::Body::find(const string &str) const
+{
+	size_t n = literal.length();
+	if (n > str.length())
+		return false;
+
+	if (!icase) {
+		if (anchor_begin && anchor_end)
+			return str == literal;
+		if (anchor_begin)
+			return str.compare(0, n, literal) == 0;
+		if (anchor_end)
+			return str.compare(str.length() - n, n, literal) == 0;
+		return str.find(literal) != string::npos;
+	}
+
+	auto eq = [](char a, char b) {
+		return tolower((unsigned char)a) == b;
+	};
+	if (anchor_begin && anchor_end)
+		return n == str.length() &&
+		    equal(str.begin(), str.end(), literal.begin(), eq);
+	if (anchor_begin)
+		return equal(str.begin(), str.begin() + n, literal.begin(), eq);
+	if (anchor_end)
+		return equal(str.end() - n, str.end(), literal.begin(), eq);
+	return search(str.begin(), str.end(), literal.begin(), literal.end(), eq) != str.end();
+}
@@ -20,6 +20,11 @@
  * Reference-counted compiled regular expressions
  * See the Handle class in Stroutrup's section 25.7
  *
+ * Extended REs that are literal strings are matched without regexec.
+ * For other extended REs, a literal that all matches must contain
+ * is searched first, so that regexec is executed only on strings
+ * that may match.
+ *
  *
  */
 
@@ -33,69 +38,82 @@
 using namespace std;
 
 class CompiledRE {
-	regex_t *re;
+	// A compiled RE and the literal used for matching it quickly
+	struct Body {
+		regex_t re;		// The POSIX compiled RE
+		bool is_literal;	// True if the RE is the literal
+		string literal;		// Literal (lowercase if icase) matches contain
+		bool anchor_begin;	// A literal RE must appear at the beginning
+		bool anchor_end;	// A literal RE must appear at the end
+		bool icase;		// True for case-insensitive matching
+
+		Body(const char *s, int flags);
+		// Return true if str contains the literal
+		bool find(const string &str) const;
+	};
+	Body *body;
 	int *refcount;
 	int ret;
+	void release() {
+		if (--(*refcount) == 0) {
+			delete refcount;
+			clear();
+		}
+	}
 public:
 	// ctor
 	CompiledRE(const char *s, int flags = 0) : refcount(new int(1)) {
-		regex_t lre;
-		if ((ret = regcomp(&lre, s, flags)) != 0)
-			re = NULL;		// Error
-		else
-			re = new regex_t(lre);
+		body = new Body(s, flags);
+		if ((ret = regcomp(&body->re, s, flags)) != 0) {
+			delete body;
+			body = NULL;		// Error
+		}
 	}
 	// Default ctor
-	CompiledRE() :  re(NULL), refcount(new int(1)), ret(0) {}
+	CompiledRE() :  body(NULL), refcount(new int(1)), ret(0) {}
 	// Copy ctor
-	CompiledRE(const CompiledRE &from) : re(from.re), refcount(from.refcount), ret(from.ret) {
+	CompiledRE(const CompiledRE &from) : body(from.body), refcount(from.refcount), ret(from.ret) {
 		(*refcount)++;
 	}
 	// Assignment operator
 	CompiledRE& operator=(const CompiledRE &rhs) {
 		if (this == &rhs) return *this;
-		if (--(*refcount) == 0) {
-			delete refcount;
-			if (re) {
-				regfree(re);
-				delete re;
-			}
-		}
-		re = rhs.re;
+		release();
+		body = rhs.body;
 		refcount = rhs.refcount;
 		ret = rhs.ret;
 		(*refcount)++;
 		return *this;
 	}
 	~CompiledRE() {
-		if (--(*refcount) == 0) {
-			delete refcount;
-			if (re) {
-				regfree(re);
-				delete re;
-			}
-		}
+		release();
 	}
 	bool isCorrect() const {
-		return re != NULL;
+		return body != NULL;
 	}
 	bool isSet() const {
-		return re != NULL;
+		return body != NULL;
 	}
 	void clear() {
-		if (re) {
-			regfree(re);
-			delete re;
+		if (body) {
+			regfree(&body->re);
+			delete body;
 		}
-		re = NULL;
+		body = NULL;
 	}
 	string getError() const {
 		char buff[1024];
-		regerror(ret, re, buff, sizeof(buff));
+		regerror(ret, NULL, buff, sizeof(buff));
 		return string(buff);
 	}
 	int exec(const string &str, size_t nmatch = 0, regmatch_t *pmatch = NULL, int eflags = 0) const {
-		return regexec(re, str.c_str(), nmatch, pmatch, eflags);
+		if (!body->literal.empty()) {
+			if (!body->find(str))
+				return REG_NOMATCH;
+			if (body->is_literal && nmatch == 0 && eflags == 0)
+				return 0;
+		}
+		return regexec(&body->re, str.c_str(), nmatch, pmatch, eflags);
 	}
 };
 
@@ -109,7 +109,7 @@ CREATE STRUCT VIEW IdentifierProperties (
 CREATE VIRTUAL TABLE cscout.IdentifierProperties
 USING STRUCT VIEW IdentifierProperties
 WITH REGISTERED C NAME ids
-WITH REGISTERED C TYPE map<Eclass *, Identifier>;
+WITH REGISTERED C TYPE FreezableMap<Eclass *, Identifier>;
 
 CREATE STRUCT VIEW Tokid (
 	// Make it an integer on all systems
@@ -119,7 +119,7 @@ CREATE STRUCT VIEW Tokid (
 
 CREATE VIRTUAL TABLE cscout.Tokids
 USING STRUCT VIEW Tokid
-WITH REGISTERED C TYPE set<Tokid>;
+WITH REGISTERED C TYPE FreezableSet<Tokid>;
 
 CREATE VIRTUAL TABLE cscout.Tokid
 USING STRUCT VIEW Tokid
@@ -143,7 +143,7 @@ CREATE STRUCT VIEW FunctionMap (
 CREATE VIRTUAL TABLE cscout.FunctionMap
 USING STRUCT VIEW FunctionMap
 WITH REGISTERED C NAME fun_map
-WITH REGISTERED C TYPE map<Tokid, Call *>;
+WITH REGISTERED C TYPE FreezableMultimap<Tokid, Call *>;
 
 
 CREATE STRUCT VIEW Call (
@@ -40,7 +40,13 @@
 #include <cstdio>		// perror, rename
 #include <cstdlib>		// atoi
 #include <cerrno>		// errno
+#include <ctime>		// time
 #include <regex.h> // regex
+#ifndef WIN32
+#include <csignal>		// signal, kill
+#include <unistd.h>		// fork
+#include <sys/wait.h>		// wait
+#endif
 
 #include <getopt.h>
 
@@ -109,7 +115,7 @@ CscoutEngine engine(opts);
 #define prohibit_remote_access(file)
 #define prohibit_browsers(file) \
 	do { \
-		if (browse_only) { \
+		if (opts.browse_only) { \
 			nonbrowse_operation_prohibited(file); \
 			return 0; \
 		} \
@@ -127,13 +133,16 @@ static enum e_modification_state {
 
 // This uses many of the above, and is therefore included here
 #include "gdisplay.h"
+#include "profile.h"
+#include "memstat.h"
+#include "job.h"
+#include "json.h"
+#include "projindex.h"
 
 // Set to true when the user has specified the application to exit
 static bool must_exit = false;
 
 
-// Set to true if we operate in browsing mode
-static bool browse_only = false;
 // Maximum number of nodes and edges allowed to browsing-only clients
 #define MAX_BROWSING_GRAPH_ELEMENTS 1000
 
@@ -208,14 +217,171 @@ html_string(FILE *of, const Call *f)
 	}
 }
 
-// Display the contents of a file in hypertext form
-static void
-file_hypertext(FILE *of, Fileid fi, bool eval_query)
+/*
+ * A file's source code rendered as HTML without any marked elements,
+ * together with the positions where queried elements can be marked.
+ */
+struct SourceRendering {
+	// A position of an element that may be marked
+	struct Anchor {
+		cs_offset_t offset;	// Offset in the file
+		size_t begin, end;	// Range of the element's HTML text, if known
+		Eclass *ec;		// Identifier's class; NULL for calls
+	};
+	string html;			// The rendered source code
+	vector <Anchor> identifiers;	// Identifiers, in file order
+	vector <Anchor> calls;		// Function and macro names, in file order
+};
+
+/*
+ * Rendered files, invalidated together with the query results,
+ * e.g. when a file is hand-edited.
+ */
+static ResultCache <SourceRendering> source_renderings(8);
+
+/*
+ * Return the HTML rendering of the file fi, or nullptr after
+ * reporting an error to of.
+ * Identifiers and calls are located by walking the ordered maps
+ * of equivalence classes and calls in parallel with the file.
+ */
+static ResultCache <SourceRendering>::ResultPtr
+source_rendering(FILE *of, Fileid fi, bool mark_unprocessed)
 {
-	istream *in;
-	const string &fname = fi.get_path();
+	string key(to_string(fi.get_id()) + (mark_unprocessed ? "u" : ""));
+	ResultCache <SourceRendering>::ResultPtr cached(source_renderings.get(key));
+	if (cached)
+		return cached;
+
+	string contents;
+	if (Filedetails::is_hand_edited(fi))
+		contents = Filedetails::get_original_contents(fi);
+	else {
+		const string &fname = fi.get_path();
+		ifstream in(fname.c_str(), ios::binary);
+		if (in.fail()) {
+			html_perror(of, "Unable to open " + fname + " for reading");
+			return nullptr;
+		}
+		ostringstream ss;
+		ss << in.rdbuf();
+		contents = ss.str();
+	}
+
+	SourceRendering r;
+	string &out = r.html;
+	out.reserve(contents.length() * 5 / 4);
 	bool at_bol = true;
 	int line_number = 1;
+	cs_offset_t id_end = 0;		// End of the last identifier found
+
+	// The file's equivalence classes in offset order
+	vector <pair <Tokid, Eclass *> > ecs;
+	Tokid::for_each_ec(Tokid(fi, 0), [&](Tokid t, Eclass *ec) {
+		if (t.get_fileid() != fi)
+			return false;
+		ecs.emplace_back(t, ec);
+		return true;
+	});
+	auto ei = ecs.cbegin();
+	auto ee = ecs.cend();
+	const auto &funs = Call::functions();
+	Call::const_fmap_iterator_type ci = funs.lower_bound(Tokid(fi, 0));
+
+	(void)html('\n');	// Reset HTML tab handling
+	for (cs_offset_t offs = 0; offs < (cs_offset_t)contents.length(); offs++) {
+		char c = contents[offs];
+		Tokid ti(fi, offs);
+		if (at_bol) {
+			char buff[100];
+			snprintf(buff, sizeof(buff), "<a name=\"%d\"></a>", line_number);
+			out += buff;
+			if (mark_unprocessed && !Filedetails::is_line_processed(fi, line_number))
+				out += "<span class=\"unused\">";
+			if (Option::show_line_number->get()) {
+				snprintf(buff, sizeof(buff), "%5d ", line_number);
+				// Do not go via HTML string to keep tabs ok
+				for (char *s = buff; *s; s++)
+					if (*s == ' ')
+						out += "&nbsp;";
+					else
+						out += *s;
+			}
+			at_bol = false;
+		}
+		while (ei != ee && ei->first < ti)
+			ei++;
+		while (ci != funs.end() && ci->first < ti)
+			ci++;
+		if (offs >= id_end && ei != ee && ei->first == ti && ei->second->is_identifier()) {
+			int len = ei->second->get_len();
+			id_end = offs + len;
+			r.identifiers.push_back(SourceRendering::Anchor{offs, out.length(), out.length() + len, ei->second});
+		}
+		if (ci != funs.end() && ci->first == ti)
+			r.calls.push_back(SourceRendering::Anchor{offs, out.length(), out.length(), NULL});
+		out += html(c);
+		if (c == '\n') {
+			at_bol = true;
+			if (mark_unprocessed && !Filedetails::is_line_processed(fi, line_number))
+				out += "</span>";
+			line_number++;
+		}
+	}
+	return source_renderings.put(key, std::move(r));
+}
+
+// Return true if the rendered text of an element is the element's name
+static inline bool
+is_plain_text(const string &html, size_t begin, const string &name)
+{
+	return html.compare(begin, name.length(), name) == 0;
+}
+
+// A range of a rendering's HTML text
+typedef pair <size_t, size_t> TextRange;
+
+/*
+ * Set ranges to the ranges of the rendered file fi occupied by the
+ * name of function c, which are more than one when the name is split,
+ * e.g. by line continuations.
+ * Return false if the name's parts are not all rendered identifiers
+ * of fi, e.g. when the name is formed through token pasting.
+ */
+static bool
+function_name_ranges(const SourceRendering &src, Fileid fi, const Call *c, vector <TextRange> &ranges)
+{
+	const Token &t = c->get_token();
+	for (dequeTpart::const_iterator i = t.get_parts_begin(); i != t.get_parts_end(); i++) {
+		Tokid ti = i->get_tokid();
+		if (ti.get_fileid() != fi)
+			return false;
+		cs_offset_t offs = (cs_offset_t)ti.get_streampos();
+		cs_offset_t end = offs + i->get_len();
+		vector <SourceRendering::Anchor>::const_iterator a = lower_bound(
+		    src.identifiers.begin(), src.identifiers.end(), offs,
+		    [](const SourceRendering::Anchor &a, cs_offset_t o) { return a.offset < o; });
+		// A part can consist of more than one identifier
+		for (; offs < end; a++) {
+			if (a == src.identifiers.end() || a->offset != offs)
+				return false;
+			if (!ranges.empty() && ranges.back().second == a->begin)
+				ranges.back().second = a->end;
+			else
+				ranges.push_back(TextRange(a->begin, a->end));
+			offs += a->end - a->begin;
+		}
+	}
+	return !ranges.empty();
+}
+
+/*
+ * Display the contents of a file in hypertext form,
+ * by marking the elements matching the query on its cached rendering.
+ */
+static void
+file_hypertext(FILE *of, Fileid fi, bool eval_query)
+{
 	bool mark_unprocessed = !!swill_getvar("marku");
 
 	/*
@@ -242,85 +408,61 @@ file_hypertext(FILE *of, Fileid fi, bool eval_query)
 	}
 
 	if (DP())
-		cout << "Write to " << fname << endl;
-	if (Filedetails::is_hand_edited(fi)) {
-		in = new istringstream(Filedetails::get_original_contents(fi));
+		cout << "Write to " << fi.get_path() << endl;
+	ResultCache <SourceRendering>::ResultPtr src(source_rendering(of, fi, mark_unprocessed));
+	if (!src)
+		return;
+	if (Filedetails::is_hand_edited(fi))
 		fputs("<p>This file has been edited by hand. The following code reflects the contents before the first CScout-invoked hand edit.</p>", of);
-	} else {
-		in = new ifstream(fname.c_str(), ios::binary);
-		if (in->fail()) {
-			html_perror(of, "Unable to open " + fname + " for reading");
-			return;
-		}
-	}
-	fputs("<hr><code>", of);
-	(void)html('\n');	// Reset HTML tab handling
-	// Go through the file character by character
-	for (;;) {
-		Tokid ti;
-		int val;
 
-		ti = Tokid(fi, in->tellg());
-		if ((val = in->get()) == EOF)
-			break;
-		if (at_bol) {
-			fprintf(of,"<a name=\"%d\"></a>", line_number);
-			if (mark_unprocessed && !Filedetails::is_line_processed(fi, line_number))
-				fprintf(of, "<span class=\"unused\">");
-			if (Option::show_line_number->get()) {
-				char buff[50];
-				snprintf(buff, sizeof(buff), "%5d ", line_number);
-				// Do not go via HTML string to keep tabs ok
-				for (char *s = buff; *s; s++)
-					if (*s == ' ')
-						fputs("&nbsp;", of);
-					else
-						fputc(*s, of);
-			}
-			at_bol = false;
-		}
-		// Identifier we can mark
-		Eclass *ec;
-		if (have_idq && (ec = ti.check_ec()) && ec->is_identifier() && idq.need_eval()) {
-			string s;
-			s = (char)val;
-			int len = ec->get_len();
-			for (int j = 1; j < len; j++)
-				s += (char)in->get();
-			Identifier i(ec, s);
-			const IdPropElem ip(ec, i);
-			if (idq.eval(ip))
-				html(of, ip);
-			else
-				html_string(of, s);
-			continue;
+	const string &text = src->html;
+	size_t pos = 0;			// Text output so far
+	fputs("<hr><code>", of);
+	if (have_idq && idq.need_eval()) {
+		for (const SourceRendering::Anchor &a : src->identifiers) {
+			if (a.begin < pos || a.end > text.length())
+				continue;
+			string s(text, a.begin, a.end - a.begin);
+			// Elements split e.g. by line continuations are not marked
+			if (s.find_first_of("&<") != string::npos)
+				continue;
+			Identifier i(a.ec, s);
+			const IdPropElem ip(a.ec, i);
+			if (!idq.eval(ip))
+				continue;
+			fwrite(text.data() + pos, 1, a.begin - pos, of);
+			html(of, ip);
+			pos = a.end;
 		}
-		// Function we can mark
-		if (have_funq && funq.need_eval()) {
-			pair <Call::const_fmap_iterator_type, Call::const_fmap_iterator_type> be(Call::get_calls(ti));
-			Call::const_fmap_iterator_type ci;
-			for (ci = be.first; ci != be.second; ci++)
+	} else if (have_funq && funq.need_eval()) {
+		for (const SourceRendering::Anchor &a : src->calls) {
+			if (a.begin < pos)
+				continue;
+			pair <Call::const_fmap_iterator_type, Call::const_fmap_iterator_type> be(Call::get_calls(Tokid(fi, a.offset)));
+			for (Call::const_fmap_iterator_type ci = be.first; ci != be.second; ci++)
 				if (funq.eval(ci->second)) {
-					string s;
-					s = (char)val;
-					int len = ci->second->get_name().length();
-					for (int j = 1; j < len; j++)
-						s += (char)in->get();
-					html(of, *(ci->second));
+					const Call *c = ci->second;
+					vector <TextRange> ranges;
+					if (!function_name_ranges(*src, fi, c, ranges) ||
+					    ranges.front().first < pos) {
+						const string &name = c->get_name();
+						if (!is_plain_text(text, a.begin, name))
+							break;
+						ranges.assign(1, TextRange(a.begin, a.begin + name.length()));
+					}
+					// Mark each part of the name
+					for (const TextRange &r : ranges) {
+						fwrite(text.data() + pos, 1, r.first - pos, of);
+						fprintf(of, "<a href=\"fun.html?f=%p\">", (void *)c);
+						fwrite(text.data() + r.first, 1, r.second - r.first, of);
+						fputs("</a>", of);
+						pos = r.second;
+					}
 					break;
 				}
-			if (ci != be.second)
-				continue;
-		}
-		fprintf(of, "%s", html((char)val));
-		if ((char)val == '\n') {
-			at_bol = true;
-			if (mark_unprocessed && !Filedetails::is_line_processed(fi, line_number))
-				fprintf(of, "</span>");
-			line_number++;
 		}
 	}
-	delete in;
+	fwrite(text.data() + pos, 1, text.length() - pos, of);
 	fputs("<hr></code>", of);
 }
 
@@ -422,6 +564,7 @@ filequery_page(FILE *of,  void *)
 	"<INPUT TYPE=\"text\" NAME=\"fre\" SIZE=20 MAXLENGTH=256>\n"
 	"<hr>\n"
 	"<p>Query title <INPUT TYPE=\"text\" NAME=\"n\" SIZE=60 MAXLENGTH=256>\n"
+	"&nbsp;&nbsp;<INPUT TYPE=\"checkbox\" NAME=\"bg\" VALUE=\"1\">Run in the background\n"
 	"&nbsp;&nbsp;<INPUT TYPE=\"submit\" NAME=\"qf\" VALUE=\"Show files\">\n"
 	"</FORM>\n"
 	, of);
@@ -429,6 +572,18 @@ filequery_page(FILE *of,  void *)
 	return 0;
 }
 
+// Caches of sorted query results, for paging through them
+static QueryCache <const IdProp::value_type *> id_results(16);
+static QueryCache <const Call *> fun_results(16);
+static QueryCache <Fileid> file_results(16);
+
+// Return the key under which the results of the query URL are cached
+static string
+result_key(const string &url)
+{
+	return url + "&project=" + to_string(current_project);
+}
+
 // Process a file query
 static int
 xfilequery_page(FILE *of,  void *)
@@ -440,34 +595,44 @@ xfilequery_page(FILE *of,  void *)
 	if (!query.is_valid())
 		return 0;
 
-	multiset <Fileid, FileQuery::FileComparator> sorted_files(query.get_comparator());
-
 	html_head(of, "xfilequery", (qname && *qname) ? qname : "File Query Results");
 
-	for (auto file : engine.get_files()) {
-		if (query.eval(file))
-			sorted_files.insert(file);
+	string key(result_key(query.base_url()));
+	QueryCache<Fileid>::ResultPtr sorted_files(file_results.get(key));
+	QueryBudget::start();
+	if (!sorted_files) {
+		multiset <Fileid, FileQuery::FileComparator> matched(query.get_comparator());
+		ProjectIndex::for_each_file(current_project, engine.get_files(), [&](Fileid file) {
+			if (QueryBudget::exhausted())
+				return false;
+			if (query.eval(file)) {
+				matched.insert(file);
+				QueryBudget::add_result();
+			}
+			return true;
+		});
+		sorted_files = file_results.put(key,
+		    QueryCache<Fileid>::Result(matched.begin(), matched.end()),
+		    !QueryBudget::is_truncated());
 	}
+	QueryBudget::html_marker(of);
 	html_file_begin(of);
-	if (modification_state != ms_subst && !browse_only)
+	if (modification_state != ms_subst && !opts.browse_only)
 		fprintf(of, "<th></th>\n");
 	if (query.get_sort_order() != -1)
 		fprintf(of, "<th>%s</th>\n", Metrics::get_name<FileMetrics>(query.get_sort_order()).c_str());
 	Pager pager(of, Option::entries_per_page->get(), query.base_url(), query.bookmarkable());
 	html_file_set_begin(of);
-	for (multiset <Fileid, FileQuery::FileComparator>::iterator i = sorted_files.begin(); i != sorted_files.end(); i++) {
-		Fileid f = *i;
-		if (current_project && !Filedetails::get_attribute(f, current_project))
-			continue;
-		if (pager.show_next()) {
-			html_file(of, *i);
-			if (modification_state != ms_subst && !browse_only)
-				fprintf(of, "<td><a href=\"fedit.html?id=%u\">edit</a></td>",
-				i->get_id());
-			if (query.get_sort_order() != -1)
-				fprintf(of, "<td align=\"right\">%g</td>", Filedetails::get_pre_cpp_const_metrics(*i).get_metric(query.get_sort_order()));
-			html_file_record_end(of);
-		}
+	auto range = pager.page_range(sorted_files->size());
+	for (int i = range.first; i < range.second; i++) {
+		Fileid f = (*sorted_files)[i];
+		html_file(of, f);
+		if (modification_state != ms_subst && !opts.browse_only)
+			fprintf(of, "<td><a href=\"fedit.html?id=%u\">edit</a></td>",
+			f.get_id());
+		if (query.get_sort_order() != -1)
+			fprintf(of, "<td align=\"right\">%g</td>", Filedetails::get_pre_cpp_const_metrics(f).get_metric(query.get_sort_order()));
+		html_file_record_end(of);
 	}
 	html_file_end(of);
 	pager.end();
@@ -481,9 +646,9 @@ xfilequery_page(FILE *of,  void *)
  * Display the sorted identifiers or functions, taking into account the reverse sort property
  * for properly aligning the output.
  */
-template <typename container>
+template <typename T>
 static void
-display_sorted(FILE *of, const Query &query, const container &sorted_ids)
+display_sorted(FILE *of, const Query &query, const vector <T> &sorted_ids)
 {
 	if (Option::sort_rev->get())
 		fputs("<table><tr><td width=\"50%\" align=\"right\">\n", of);
@@ -491,12 +656,10 @@ display_sorted(FILE *of, const Query &query, const container &sorted_ids)
 		fputs("<p>\n", of);
 
 	Pager pager(of, Option::entries_per_page->get(), query.base_url() + "&qi=1", query.bookmarkable());
-	typename container::const_iterator i;
-	for (i = sorted_ids.begin(); i != sorted_ids.end(); i++) {
-		if (pager.show_next()) {
-			html(of, **i);
-			fputs("<br>\n", of);
-		}
+	auto range = pager.page_range(sorted_ids.size());
+	for (int i = range.first; i < range.second; i++) {
+		html(of, *sorted_ids[i]);
+		fputs("<br>\n", of);
 	}
 
 	if (Option::sort_rev->get())
@@ -512,7 +675,7 @@ display_sorted(FILE *of, const Query &query, const container &sorted_ids)
  * for properly aligning the output.
  */
 static void
-display_sorted_function_metrics(FILE *of, const FunQuery &query, const Sfuns &sorted_ids)
+display_sorted_function_metrics(FILE *of, const FunQuery &query, const vector <const Call *> &sorted_ids)
 {
 	fprintf(of, "<table class=\"metrics\"><tr>"
 	    "<th width='50%%' align='left'>Name</th>"
@@ -520,13 +683,12 @@ display_sorted_function_metrics(FILE *of, const FunQuery &query, const Sfuns &so
 	    Metrics::get_name<FunMetrics>(query.get_sort_order()).c_str());
 
 	Pager pager(of, Option::entries_per_page->get(), query.base_url() + "&qi=1", query.bookmarkable());
-	for (Sfuns::const_iterator i = sorted_ids.begin(); i != sorted_ids.end(); i++) {
-		if (pager.show_next()) {
-			fputs("<tr><td witdh='50%'>", of);
-			html(of, **i);
-			fprintf(of, "</td><td witdh='50%%' align='right'>%g</td></tr>\n",
-			    (*i)->get_pre_cpp_const_metrics().get_metric(query.get_sort_order()));
-		}
+	auto range = pager.page_range(sorted_ids.size());
+	for (int i = range.first; i < range.second; i++) {
+		fputs("<tr><td witdh='50%'>", of);
+		html(of, *sorted_ids[i]);
+		fprintf(of, "</td><td witdh='50%%' align='right'>%g</td></tr>\n",
+		    sorted_ids[i]->get_pre_cpp_const_metrics().get_metric(query.get_sort_order()));
 	}
 	fputs("</table>\n", of);
 	pager.end();
@@ -573,6 +735,7 @@ iquery_page(FILE *of,  void *)
 	"</table>\n"
 	"<hr>\n"
 	"<p>Query title <INPUT TYPE=\"text\" NAME=\"n\" SIZE=60 MAXLENGTH=256>\n"
+	"&nbsp;&nbsp;<INPUT TYPE=\"checkbox\" NAME=\"bg\" VALUE=\"1\">Run in the background\n"
 	"&nbsp;&nbsp;<INPUT TYPE=\"submit\" NAME=\"qi\" VALUE=\"Show identifiers\">\n"
 	"<INPUT TYPE=\"submit\" NAME=\"qf\" VALUE=\"Show files\">\n"
 	"<INPUT TYPE=\"submit\" NAME=\"qfun\" VALUE=\"Show functions\">\n"
@@ -651,6 +814,7 @@ funquery_page(FILE *of,  void *)
 	"</table>\n"
 	"<hr>\n"
 	"<p>Query title <INPUT TYPE=\"text\" NAME=\"n\" SIZE=60 MAXLENGTH=256>\n"
+	"&nbsp;&nbsp;<INPUT TYPE=\"checkbox\" NAME=\"bg\" VALUE=\"1\">Run in the background\n"
 	"&nbsp;&nbsp;<INPUT TYPE=\"submit\" NAME=\"qi\" VALUE=\"Show functions\">\n"
 	"<INPUT TYPE=\"submit\" NAME=\"qf\" VALUE=\"Show files\">\n"
 	"</FORM>\n"
@@ -660,7 +824,7 @@ funquery_page(FILE *of,  void *)
 }
 
 void
-display_files(FILE *of, const Query &query, const IFSet &sorted_files)
+display_files(FILE *of, const Query &query, const vector <Fileid> &sorted_files)
 {
 	const string query_url(query.param_url());
 
@@ -668,25 +832,33 @@ display_files(FILE *of, const Query &query, const IFSet &sorted_files)
 	html_file_begin(of);
 	html_file_set_begin(of);
 	Pager pager(of, Option::entries_per_page->get(), query.base_url() + "&qf=1", query.bookmarkable());
-	for (IFSet::iterator i = sorted_files.begin(); i != sorted_files.end(); i++) {
-		Fileid f = *i;
-		if (current_project && !Filedetails::get_attribute(f, current_project))
-			continue;
-		if (pager.show_next()) {
-			html_file(of, *i);
-			fprintf(of, "<td><a href=\"qsrc.html?id=%u&%s\">marked source</a></td>",
-				f.get_id(),
-				query_url.c_str());
-			if (modification_state != ms_subst && !browse_only)
-				fprintf(of, "<td><a href=\"fedit.html?id=%u\">edit</a></td>",
-				f.get_id());
-			html_file_record_end(of);
-		}
+	auto range = pager.page_range(sorted_files.size());
+	for (int i = range.first; i < range.second; i++) {
+		Fileid f = sorted_files[i];
+		html_file(of, f);
+		fprintf(of, "<td><a href=\"qsrc.html?id=%u&%s\">marked source</a></td>",
+			f.get_id(),
+			query_url.c_str());
+		if (modification_state != ms_subst && !opts.browse_only)
+			fprintf(of, "<td><a href=\"fedit.html?id=%u\">edit</a></td>",
+			f.get_id());
+		html_file_record_end(of);
 	}
 	html_file_end(of);
 	pager.end();
 }
 
+// Return the files of the sorted set that belong to the current project
+static QueryCache<Fileid>::Result
+project_files(const IFSet &files)
+{
+	QueryCache<Fileid>::Result r;
+	for (auto f : files)
+		if (!current_project || Filedetails::get_attribute(f, current_project))
+			r.push_back(f);
+	return r;
+}
+
 // Process an identifier query
 static int
 xiquery_page(FILE *of,  void *)
@@ -694,9 +866,6 @@ xiquery_page(FILE *of,  void *)
 	Timer timer;
 	prohibit_remote_access(of);
 
-	Sids sorted_ids;
-	IFSet sorted_files;
-	set <Call *> funs;
 	bool q_id = !!swill_getvar("qi");	// Show matching identifiers
 	bool q_file = !!swill_getvar("qf");	// Show matching files
 	bool q_fun = !!swill_getvar("qfun");	// Show matching functions
@@ -709,37 +878,78 @@ xiquery_page(FILE *of,  void *)
 	}
 
 	html_head(of, "xiquery", (qname && *qname) ? qname : "Identifier Query Results");
-	if (!opts.is_quiet())
-	    cerr << "Evaluating identifier query" << endl;
-	for (IdProp::iterator i = ids.begin(); i != ids.end(); i++) {
-		progress(i, ids);
-		if (!query.eval(*i))
-			continue;
+
+	string id_key(result_key(query.base_url() + "&qi=1"));
+	string file_key(result_key(query.base_url() + "&qf=1"));
+	string fun_key(result_key(query.base_url() + "&qfun=1"));
+	QueryCache<const IdProp::value_type *>::ResultPtr sorted_ids;
+	QueryCache<Fileid>::ResultPtr sorted_files;
+	QueryCache<const Call *>::ResultPtr sorted_funs;
+	if (q_id)
+		sorted_ids = id_results.get(id_key);
+	else if (q_file)
+		sorted_files = file_results.get(file_key);
+	else if (q_fun)
+		sorted_funs = fun_results.get(fun_key);
+
+	QueryBudget::start();
+	if (!sorted_ids && !sorted_files && !sorted_funs) {
+		Sids matched_ids;
+		IFSet matched_files;
+		set <Call *> funs;
+
+		if (!opts.is_quiet())
+		    cerr << "Evaluating identifier query" << endl;
+		Attributes::size_type scope = query.get_project_scope();
+		size_t n = 0, total = ProjectIndex::count_identifiers(scope);
+		ProjectIndex::for_each_identifier(scope, [&](const IdPropElem &i) {
+			progress(++n, total);
+			if (QueryBudget::exhausted())
+				return false;
+			if (!query.eval(i))
+				return true;
+			QueryBudget::add_result();
+			if (q_id)
+				matched_ids.insert(&i);
+			else if (q_file) {
+				const vector <Fileid> &f = i.first->sorted_files();
+				matched_files.insert(f.begin(), f.end());
+			} else if (q_fun) {
+				const vector <Call *> &ecfuns = i.first->functions();
+				funs.insert(ecfuns.begin(), ecfuns.end());
+			}
+			return true;
+		});
+		if (!opts.is_quiet())
+		    cerr << endl;
+		bool complete = !QueryBudget::is_truncated();
 		if (q_id)
-			sorted_ids.insert(&*i);
-		else if (q_file) {
-			IFSet f = i->first->sorted_files();
-			sorted_files.insert(f.begin(), f.end());
-		} else if (q_fun) {
-			set <Call *> ecfuns(i->first->functions());
-			funs.insert(ecfuns.begin(), ecfuns.end());
+			sorted_ids = id_results.put(id_key,
+			    QueryCache<const IdProp::value_type *>::Result(matched_ids.begin(), matched_ids.end()),
+			    complete);
+		else if (q_file)
+			sorted_files = file_results.put(file_key, project_files(matched_files), complete);
+		else if (q_fun) {
+			Sfuns matched_funs([](const Call *a, const Call *b) {
+				return Query::string_bi_compare(a->get_name(), b->get_name());
+			});
+			matched_funs.insert(funs.begin(), funs.end());
+			sorted_funs = fun_results.put(fun_key,
+			    QueryCache<const Call *>::Result(matched_funs.begin(), matched_funs.end()),
+			    complete);
 		}
 	}
-	if (!opts.is_quiet())
-	    cerr << endl;
-	if (q_id) {
+	QueryBudget::html_marker(of);
+
+	if (sorted_ids) {
 		fputs("<h2>Matching Identifiers</h2>\n", of);
-		display_sorted(of, query, sorted_ids);
+		display_sorted(of, query, *sorted_ids);
 	}
-	if (q_file)
-		display_files(of, query, sorted_files);
-	if (q_fun) {
+	if (sorted_files)
+		display_files(of, query, *sorted_files);
+	if (sorted_funs) {
 		fputs("<h2>Matching Functions</h2>\n", of);
-		Sfuns sorted_funs([](const Call *a, const Call *b) {
-			return Query::string_bi_compare(a->get_name(), b->get_name());
-		});
-		sorted_funs.insert(funs.begin(), funs.end());
-		display_sorted(of, query, sorted_funs);
+		display_sorted(of, query, *sorted_funs);
 	}
 
 	timer.print_elapsed(of);
@@ -754,39 +964,68 @@ xfunquery_page(FILE *of,  void *)
 	prohibit_remote_access(of);
 	Timer timer;
 
-	IFSet sorted_files;
 	bool q_id = !!swill_getvar("qi");	// Show matching identifiers
 	bool q_file = !!swill_getvar("qf");	// Show matching files
 	char *qname = swill_getvar("n");
 	FunQuery query(of, Option::file_icase->get(), current_project);
-	Sfuns sorted_funs(query.get_comparator());
 
 	if (!query.is_valid())
 		return 0;
 
 	html_head(of, "xfunquery", (qname && *qname) ? qname : "Function Query Results");
-	if (!opts.is_quiet())
-	    cerr << "Evaluating function query" << endl;
-	for (Call::const_fmap_iterator_type i = Call::fbegin(); i != Call::fend(); i++) {
-		progress(i, Call::functions());
-		if (!query.eval(i->second))
-			continue;
+
+	string fun_key(result_key(query.base_url() + "&qi=1"));
+	string file_key(result_key(query.base_url() + "&qf=1"));
+	QueryCache<const Call *>::ResultPtr sorted_funs;
+	QueryCache<Fileid>::ResultPtr sorted_files;
+	if (q_id)
+		sorted_funs = fun_results.get(fun_key);
+	if (q_file)
+		sorted_files = file_results.get(file_key);
+
+	QueryBudget::start();
+	if ((q_id && !sorted_funs) || (q_file && !sorted_files)) {
+		Sfuns matched_funs(query.get_comparator());
+		IFSet matched_files;
+
+		if (!opts.is_quiet())
+		    cerr << "Evaluating function query" << endl;
+		Attributes::size_type scope = query.get_project_scope();
+		size_t n = 0, total = ProjectIndex::count_functions(scope);
+		ProjectIndex::for_each_function(scope, [&](Call *c) {
+			progress(++n, total);
+			if (QueryBudget::exhausted())
+				return false;
+			if (!query.eval(c))
+				return true;
+			QueryBudget::add_result();
+			if (q_id)
+				matched_funs.insert(c);
+			if (q_file)
+				matched_files.insert(c->get_fileid());
+			return true;
+		});
+		if (!opts.is_quiet())
+		    cerr << endl;
+		bool complete = !QueryBudget::is_truncated();
 		if (q_id)
-			sorted_funs.insert(i->second);
+			sorted_funs = fun_results.put(fun_key,
+			    QueryCache<const Call *>::Result(matched_funs.begin(), matched_funs.end()),
+			    complete);
 		if (q_file)
-			sorted_files.insert(i->second->get_fileid());
+			sorted_files = file_results.put(file_key, project_files(matched_files), complete);
 	}
-	if (!opts.is_quiet())
-	    cerr << endl;
+	QueryBudget::html_marker(of);
+
 	if (q_id) {
 		fputs("<h2>Matching Functions</h2>\n", of);
 		if (query.get_sort_order() != -1)
-			display_sorted_function_metrics(of, query, sorted_funs);
+			display_sorted_function_metrics(of, query, *sorted_funs);
 		else
-			display_sorted(of, query, sorted_funs);
+			display_sorted(of, query, *sorted_funs);
 	}
 	if (q_file)
-		display_files(of, query, sorted_files);
+		display_files(of, query, *sorted_files);
 	timer.print_elapsed(of);
 	html_tail(of);
 	return 0;
@@ -831,8 +1070,13 @@ identifier_page(FILE *fo, void *)
 		fprintf(fo, "Missing value");
 		return 0;
 	}
+	IdProp::iterator idi = ids.find(e);
+	if (idi == ids.end()) {
+		fprintf(fo, "Unknown identifier");
+		return 0;
+	}
 	char *subst;
-	Identifier &id = ids[e];
+	Identifier &id = idi->second;
 	if ((subst = swill_getvar("sname"))) {
 		if (modification_state == ms_hand_edit) {
 			change_prohibited(fo);
@@ -846,6 +1090,7 @@ identifier_page(FILE *fo, void *)
 		string ssubst(subst);
 		id.set_newid(ssubst);
 		modification_state = ms_subst;
+		QueryCacheBase::invalidate();
 	}
 	html_head(fo, "id", string("Identifier: ") + html(id.get_id()));
 	fprintf(fo, "<FORM ACTION=\"id.html\" METHOD=\"GET\">\n<ul>\n");
@@ -889,7 +1134,7 @@ identifier_page(FILE *fo, void *)
 
 	if ((!e->get_attribute(is_readonly) || Option::rename_override_ro->get()) &&
 	    modification_state != ms_hand_edit &&
-	    !browse_only) {
+	    !opts.browse_only) {
 		fprintf(fo, "<li> Substitute with: \n"
 			"<INPUT TYPE=\"text\" NAME=\"sname\" VALUE=\"%s\" SIZE=10 MAXLENGTH=256> "
 			"<INPUT TYPE=\"submit\" NAME=\"repl\" VALUE=\"Save\">\n",
@@ -952,7 +1197,7 @@ function_page(FILE *fo, void *)
 			fprintf(fo, " &mdash; <a href=\"qsrc.html?qt=fun&id=%u&match=Y&call=%p&n=Declaration+of+%s\">marked source</a>",
 				t.get_fileid().get_id(),
 				(void *)f, f->get_name().c_str());
-			if (modification_state != ms_subst && !browse_only)
+			if (modification_state != ms_subst && !opts.browse_only)
 				fprintf(fo, " &mdash; <a href=\"fedit.html?id=%u&re=%s\">edit</a>",
 				t.get_fileid().get_id(), f->get_name().c_str());
 	}
@@ -964,7 +1209,7 @@ function_page(FILE *fo, void *)
 		int lnum = Filedetails::get_line_number(t.get_fileid(), t.get_streampos());
 		fprintf(fo, " <a href=\"src.html?id=%u#%d\">line %d</a>\n",
 			t.get_fileid().get_id(), lnum, lnum);
-		if (modification_state != ms_subst && !browse_only)
+		if (modification_state != ms_subst && !opts.browse_only)
 			fprintf(fo, " &mdash; <a href=\"fedit.html?id=%u&re=%s\">edit</a>",
 			t.get_fileid().get_id(), f->get_name().c_str());
 	} else
@@ -985,7 +1230,7 @@ function_page(FILE *fo, void *)
 	Eclass *ec;
 	if (f->get_token().get_parts_size() == 1 &&
 	    modification_state != ms_hand_edit &&
-	    !browse_only &&
+	    !opts.browse_only &&
 	    (ec = f->get_token().get_parts_begin()->get_tokid().check_ec()) &&
 	    (!ec->get_attribute(is_readonly) || Option::refactor_fun_arg_override_ro->get())
 	    ) {
@@ -1071,21 +1316,72 @@ visit_functions(FILE *fo, const char *call_path, Call *f,
 	if (level == 0)
 		return;
 
-	Call::const_fiterator_type i;
+	// Explicit stack of the functions being visited, in depth-first order
+	struct Frame {
+		Call *f;
+		Call::const_fiterator_type i;	// Next associated function
+		int level;
+	};
+	vector <Frame> stack;
 
 	f->set_visited(visit_id);
-	for (i = (f->*fbegin)(); i != (f->*fend)(); i++) {
-		if (show && (!(*i)->is_visited(visit_id) || *i == f)) {
+	stack.push_back(Frame{f, (f->*fbegin)(), level});
+	while (!stack.empty()) {
+		if (QueryBudget::exhausted())
+			break;
+		Frame &top = stack.back();
+		if (top.i == (top.f->*fend)()) {
+			stack.pop_back();
+			continue;
+		}
+		Call *parent = top.f;
+		Call *c = *top.i++;
+		int child_level = top.level - 1;
+		if (show && (!c->is_visited(visit_id) || c == parent)) {
+			QueryBudget::add_result();
 			fprintf(fo, "<li> ");
-			html(fo, **i);
+			html(fo, *c);
 			if (recurse && call_path)
-				fprintf(fo, call_path, *i);
+				fprintf(fo, call_path, c);
+		}
+		if (recurse && !c->is_visited(visit_id) && child_level != 0) {
+			c->set_visited(visit_id);
+			stack.push_back(Frame{c, (c->*fbegin)(), child_level});
 		}
-		if (recurse && !(*i)->is_visited(visit_id))
-			visit_functions(fo, call_path, *i, fbegin, fend, recurse, show, level - 1, visit_id);
 	}
 }
 
+/*
+ * Set visit_id on all functions reachable from f through the
+ * relationship obtained through fbegin and fend, without expanding
+ * the function stop.
+ * Return the reached functions in the order they were reached.
+ */
+static vector <Call *>
+reach_functions(Call *f, Call *stop,
+	Call::const_fiterator_type (Call::*fbegin)() const,
+	Call::const_fiterator_type (Call::*fend)() const,
+	int visit_id)
+{
+	vector <Call *> reached;
+
+	f->set_visited(visit_id);
+	reached.push_back(f);
+	for (vector <Call *>::size_type n = 0; n < reached.size(); n++) {
+		if (QueryBudget::exhausted())
+			break;
+		Call *c = reached[n];
+		if (c == stop && c != f)
+			continue;
+		for (Call::const_fiterator_type i = (c->*fbegin)(); i != (c->*fend)(); i++)
+			if (!(*i)->is_visited(visit_id)) {
+				(*i)->set_visited(visit_id);
+				reached.push_back(*i);
+			}
+	}
+	return reached;
+}
+
 /*
  * Visit all files associated with a includes/included relationship with f
  * The method to obtain the relationship container is passed through
@@ -1139,11 +1435,11 @@ visit_globobj_files(Fileid f, const Fileidset & (*get_fileid_set)(Fileid fi),
  * (a control dependency).
  * The methods to obtain the relationship iterators are passed through
  * the abegin and aend method pointers.
- * Set the visited flag for all nodes visited and the edges matrix for
+ * Set the visited flag for all nodes visited and add to edges
  * the corresponding edges.
  */
 static void
-visit_fcall_files(Fileid f, Call::const_fiterator_type (Call::*abegin)() const, Call::const_fiterator_type (Call::*aend)() const, int level, EdgeMatrix &edges)
+visit_fcall_files(Fileid f, Call::const_fiterator_type (Call::*abegin)() const, Call::const_fiterator_type (Call::*aend)() const, int level, FileEdges &edges)
 {
 	if (level == 0)
 		return;
@@ -1162,7 +1458,7 @@ visit_fcall_files(Fileid f, Call::const_fiterator_type (Call::*abegin)() const,
 		for (Call::const_fiterator_type afun = ((*filefun)->*abegin)(); afun != ((*filefun)->*aend)(); afun++)
 			if ((*afun)->is_defined() && (*afun)->is_cfun()) {
 				Fileid f2((*afun)->get_definition().get_fileid());
-				edges[f.get_id()][f2.get_id()] = true;
+				edges[f].insert(f2);
 				if (!Filedetails::is_visited(f2))
 					visit_fcall_files(f2, abegin, aend, level - 1, edges);
 			}
@@ -1276,50 +1572,92 @@ funlist_page(FILE *fo, void *)
 	} else {
 		fprintf(fo, "<ul>\n");
 		Call::clear_visit_flags();
+		QueryBudget::start();
 		visit_functions(fo, buff, f, fbegin, fend, recurse, true, Option::cgraph_depth->get());
 		fprintf(fo, "</ul>\n");
+		QueryBudget::html_marker(fo);
 	}
 	html_tail(fo);
 	return 0;
 }
 
-// Display the call paths between functions from and to
-// This should be called once to generate the nodes and a second time
-// to generate the edges
+/*
+ * Count an element added to a graph and return true if the graph
+ * has reached its size limit or exhausted its query budget.
+ */
 static bool
-call_path(GraphDisplay *gd, Call *from, Call *to, bool generate_nodes)
+graph_limit(int &count)
 {
-	bool ret = false;
+	if (opts.browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
+		return true;
+	QueryBudget::add_result();
+	return QueryBudget::exhausted();
+}
 
-	from->set_visited();
-	if (DP())
-		cout << "From path: from: " << from->get_name() << " to " << to->get_name() << endl;
+// Start the budget of a graph served through the web interface
+static void
+graph_budget_start(GraphDisplay *gd)
+{
+	if (gd->uses_swill)
+		QueryBudget::start();
+}
+
+// Mark a graph truncated by its budget
+static void
+graph_truncated(GraphDisplay *gd)
+{
+	if (QueryBudget::is_truncated())
+		gd->truncated(QueryBudget::truncation_message().c_str());
+}
+
+// Visit flags of the forward and backward call path searches
+enum { visit_forward = 1, visit_backward = 2 };
+
+// Return true if the call from a to b lies on a path from from to to
+static inline bool
+on_call_path(Call *a, Call *b, Call *from, Call *to)
+{
+	return a != to && b != from &&
+	    a->is_visited(visit_forward) && b->is_visited(visit_backward);
+}
+
+/*
+ * Display the call paths between functions from and to.
+ * A function lies on such a path if it is reachable from from
+ * and if to is reachable from it, so rather than enumerating
+ * paths, search forward from from and backward from to, and
+ * display the calls that lead from the first set to the second.
+ * Paths do not return to from or continue past to.
+ * This should be called once to generate the nodes and a second time
+ * to generate the edges
+ */
+static void
+call_path(GraphDisplay *gd, const vector <Call *> &forward, Call *from, Call *to, bool generate_nodes)
+{
 	int count = 0;
-	for (Call::const_fiterator_type i = from->call_begin(); i != from->call_end(); i++)
-		if (!(*i)->is_visited() && (*i == to || call_path(gd, *i, to, generate_nodes))) {
+	for (Call *f : forward)
+		for (Call::const_fiterator_type i = f->call_begin(); i != f->call_end(); i++) {
+			if (!on_call_path(f, *i, from, to))
+				continue;
 			if (generate_nodes) {
-				if (!from->is_printed()) {
-					gd->node(from);
-					from->set_printed();
-					if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
-						break;
+				if (!f->is_printed()) {
+					gd->node(f);
+					f->set_printed();
+					if (graph_limit(count))
+						return;
 				}
 				if (!(*i)->is_printed()) {
 					gd->node(*i);
 					(*i)->set_printed();
-					if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
-						break;
+					if (graph_limit(count))
+						return;
 				}
 			} else {
-				gd->edge(from, *i);
-				if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
-					break;
+				gd->edge(f, *i);
+				if (graph_limit(count))
+					return;
 			}
-			ret = true;
 		}
-	if (DP())
-		cout << "Returns " << ret << endl;
-	return (ret);
 }
 
 // List the call graph from one function to another
@@ -1343,14 +1681,469 @@ cpath_page(GraphDisplay *gd)
 	    function_label(to, true));
 	Call::clear_print_flags();
 	Call::clear_visit_flags();
-	call_path(gd, from, to, true);
-	Call::clear_visit_flags();
-	call_path(gd, from, to, false);
+	graph_budget_start(gd);
+	vector <Call *> forward(reach_functions(from, to, &Call::call_begin, &Call::call_end, visit_forward));
+	reach_functions(to, from, &Call::caller_begin, &Call::caller_end, visit_backward);
+	call_path(gd, forward, from, to, true);
+	call_path(gd, forward, from, to, false);
+	graph_truncated(gd);
 	gd->tail();
 	return 0;
 }
 
 
+/*
+ * Pages returning JSON, for use by programs.
+ * Rather than building and sorting the complete results, as the
+ * corresponding HTML pages do, query results are output in the
+ * order they are found, as they are found.
+ */
+
+// Mark the response as JSON
+static void
+json_content()
+{
+	swill_setheader("Content-Type", "application/json");
+}
+
+// Output a JSON error object
+static void
+json_error(FILE *of, const string &msg)
+{
+	JsonWriter(of).begin_object().member("error", msg).end_object();
+}
+
+/*
+ * Return a temporary file for collecting the errors of a query's
+ * construction, or of, if such a file cannot be created.
+ */
+static FILE *
+json_error_file(FILE *of)
+{
+	FILE *err = tmpfile();
+	return err ? err : of;
+}
+
+/*
+ * Close the error file err, and return the query's validity.
+ * For an invalid query output the collected errors, without
+ * their HTML markup, as a JSON error object.
+ */
+static bool
+json_query_valid(FILE *of, FILE *err, bool valid)
+{
+	if (err == of)
+		return valid;
+	if (!valid) {
+		string msg;
+		bool in_tag = false;
+		int c;
+		rewind(err);
+		while ((c = getc(err)) != EOF)
+			if (c == '<')
+				in_tag = true;
+			else if (c == '>') {
+				in_tag = false;
+				msg += ' ';
+			} else if (!in_tag)
+				msg += (char)c;
+		json_error(of, msg.empty() ? "Invalid query" : msg);
+	}
+	fclose(err);
+	return valid;
+}
+
+// Output a note on the results' truncation by the query's budget
+static void
+json_truncated(JsonWriter &w)
+{
+	if (QueryBudget::is_truncated())
+		w.member("truncated", QueryBudget::truncation_message());
+}
+
+static void
+json_identifier(JsonWriter &w, const IdPropElem &i)
+{
+	Eclass *e = i.first;
+	w.begin_object()
+	    .member("id", (const void *)e)
+	    .member("name", i.second.get_id())
+	    .member("occurrences", e->get_size())
+	    .member("xfile", i.second.get_xfile())
+	    .member("unused", e->is_unused())
+	    .end_object();
+}
+
+static void
+json_function(JsonWriter &w, const Call *f)
+{
+	Tokid t = f->get_site();
+	w.begin_object()
+	    .member("id", (const void *)f)
+	    .member("name", f->get_name())
+	    .member("type", f->entity_type_name())
+	    .member("file_scoped", f->is_file_scoped())
+	    .member("defined", f->is_defined())
+	    .member("file", t.get_fileid().get_id())
+	    .member("line", Filedetails::get_line_number(t.get_fileid(), t.get_streampos()))
+	    .member("calls", f->get_num_call())
+	    .member("callers", f->get_num_caller())
+	    .end_object();
+}
+
+static void
+json_file(JsonWriter &w, Fileid f)
+{
+	w.begin_object()
+	    .member("id", f.get_id())
+	    .member("path", f.get_path())
+	    .member("readonly", f.get_readonly())
+	    .end_object();
+}
+
+/*
+ * Output the metrics of class M, keyed by their database field names.
+ * Set file_only to output only the metrics that apply to files.
+ */
+template <class M>
+static void
+json_metrics(JsonWriter &w, const M &pre, const M &post, bool file_only = false)
+{
+	w.key("metrics").begin_object();
+	for (int j = 0; j < M::metric_max; j++) {
+		if (Metrics::is_internal<M>(j))
+			continue;
+		if (file_only && !Metrics::is_file<M>(j))
+			continue;
+		w.key(Metrics::get_dbfield<M>(j)).begin_object()
+		    .member("name", Metrics::get_name<M>(j));
+		if (Metrics::is_pre_cpp<M>(j))
+			w.member("pre_cpp", pre.get_metric(j));
+		if (Metrics::is_post_cpp<M>(j))
+			w.member("post_cpp", post.get_metric(j));
+		w.end_object();
+	}
+	w.end_object();
+}
+
+// Output the projects whose attribute is set in has_project
+template <typename P>
+static void
+json_projects(JsonWriter &w, P has_project)
+{
+	w.key("projects").begin_array();
+	for (Attributes::size_type j = attr_end; j < Attributes::get_num_attributes(); j++)
+		if (has_project(j))
+			w.value(Project::get_projname(j));
+	w.end_array();
+}
+
+/*
+ * Identifier query, taking the parameters of xiquery.html.
+ * Output the matching identifiers, or, with qf or qfun set,
+ * the files or the functions in which they appear.
+ */
+static int
+xiquery_json_page(FILE *of, void *)
+{
+	prohibit_remote_access(of);
+	json_content();
+
+	bool q_file = !!swill_getvar("qf");
+	bool q_fun = !!swill_getvar("qfun");
+	FILE *err = json_error_file(of);
+	IdQuery query(err, Option::file_icase->get(), current_project);
+	if (!json_query_valid(of, err, query.is_valid()))
+		return 0;
+
+	JsonWriter w(of);
+	w.begin_object().key(q_file ? "files" : q_fun ? "functions" : "identifiers").begin_array();
+	// Files and functions can be reached through many identifiers
+	set <Fileid> seen_files;
+	set <Call *> seen_funs;
+	QueryBudget::start();
+	ProjectIndex::for_each_identifier(query.get_project_scope(), [&](const IdPropElem &i) {
+		if (QueryBudget::exhausted())
+			return false;
+		if (!query.eval(i))
+			return true;
+		QueryBudget::add_result();
+		if (q_file) {
+			for (Fileid f : i.first->sorted_files())
+				if ((!current_project || Filedetails::get_attribute(f, current_project)) &&
+				    seen_files.insert(f).second)
+					json_file(w, f);
+		} else if (q_fun) {
+			for (Call *f : i.first->functions())
+				if (seen_funs.insert(f).second)
+					json_function(w, f);
+		} else
+			json_identifier(w, i);
+		return true;
+	});
+	w.end_array();
+	json_truncated(w);
+	w.end_object();
+	return 0;
+}
+
+/*
+ * Function query, taking the parameters of xfunquery.html.
+ * Output the matching functions, and, with qf set, the files
+ * in which they are declared.
+ */
+static int
+xfunquery_json_page(FILE *of, void *)
+{
+	prohibit_remote_access(of);
+	json_content();
+
+	bool q_file = !!swill_getvar("qf");
+	bool q_id = !!swill_getvar("qi") || !q_file;
+	FILE *err = json_error_file(of);
+	FunQuery query(err, Option::file_icase->get(), current_project);
+	if (!json_query_valid(of, err, query.is_valid()))
+		return 0;
+
+	JsonWriter w(of);
+	w.begin_object();
+	if (q_id)
+		w.key("functions").begin_array();
+	set <Fileid> files;
+	QueryBudget::start();
+	ProjectIndex::for_each_function(query.get_project_scope(), [&](Call *c) {
+		if (QueryBudget::exhausted())
+			return false;
+		if (!query.eval(c))
+			return true;
+		QueryBudget::add_result();
+		if (q_id)
+			json_function(w, c);
+		if (q_file)
+			files.insert(c->get_fileid());
+		return true;
+	});
+	if (q_id)
+		w.end_array();
+	if (q_file) {
+		w.key("files").begin_array();
+		for (Fileid f : files)
+			if (!current_project || Filedetails::get_attribute(f, current_project))
+				json_file(w, f);
+		w.end_array();
+	}
+	json_truncated(w);
+	w.end_object();
+	return 0;
+}
+
+/*
+ * File query, taking the parameters of xfilequery.html.
+ * When the query orders files by a metric, each file is
+ * output together with the metric's value.
+ */
+static int
+xfilequery_json_page(FILE *of, void *)
+{
+	json_content();
+
+	FILE *err = json_error_file(of);
+	FileQuery query(err, Option::file_icase->get(), current_project);
+	if (!json_query_valid(of, err, query.is_valid()))
+		return 0;
+
+	JsonWriter w(of);
+	w.begin_object().key("files").begin_array();
+	QueryBudget::start();
+	ProjectIndex::for_each_file(current_project, engine.get_files(), [&](Fileid file) {
+		if (QueryBudget::exhausted())
+			return false;
+		if (!query.eval(file))
+			return true;
+		QueryBudget::add_result();
+		if (query.get_sort_order() == -1)
+			json_file(w, file);
+		else
+			w.begin_object()
+			    .member("id", file.get_id())
+			    .member("path", file.get_path())
+			    .member("readonly", file.get_readonly())
+			    .member(Metrics::get_dbfield<FileMetrics>(query.get_sort_order()),
+				Filedetails::get_pre_cpp_const_metrics(file).get_metric(query.get_sort_order()))
+			    .end_object();
+		return true;
+	});
+	w.end_array();
+	json_truncated(w);
+	w.end_object();
+	return 0;
+}
+
+// Details of an identifier, as in id.html
+static int
+identifier_json_page(FILE *of, void *)
+{
+	json_content();
+	Eclass *e;
+	if (!swill_getargs("p(id)", &e)) {
+		json_error(of, "Missing value");
+		return 0;
+	}
+	IdProp::iterator i = ids.find(e);
+	if (i == ids.end()) {
+		json_error(of, "Unknown identifier");
+		return 0;
+	}
+	JsonWriter w(of);
+	w.begin_object()
+	    .member("id", (const void *)e)
+	    .member("name", i->second.get_id())
+	    .member("occurrences", e->get_size())
+	    .member("xfile", i->second.get_xfile())
+	    .member("unused", e->is_unused());
+	if (i->second.get_replaced())
+		w.member("replacement", i->second.get_newid());
+	w.key("attributes").begin_object();
+	for (int a = attr_begin; a < attr_end; a++)
+		w.member(Attributes::name(a), e->get_attribute(a));
+	w.end_object();
+	json_projects(w, [e](Attributes::size_type j) { return e->get_attribute(j); });
+	// Functions whose name contains the identifier
+	w.key("functions").begin_array();
+	if (e->get_attribute(is_cfunction) || e->get_attribute(is_macro))
+		for (Call::const_fmap_iterator_type f = Call::fbegin(); f != Call::fend(); f++)
+			if (f->second->contains(e))
+				json_function(w, f->second);
+	w.end_array();
+	w.end_object();
+	return 0;
+}
+
+// Details of a function, as in fun.html, with its direct calls and callers
+static int
+function_json_page(FILE *of, void *)
+{
+	json_content();
+	Call *f;
+	if (!swill_getargs("p(f)", &f)) {
+		json_error(of, "Missing value");
+		return 0;
+	}
+	JsonWriter w(of);
+	w.begin_object()
+	    .member("id", (const void *)f)
+	    .member("name", f->get_name())
+	    .member("type", f->entity_type_name())
+	    .member("file_scoped", f->is_file_scoped())
+	    .member("declared", f->is_declared())
+	    .member("defined", f->is_defined());
+	if (f->is_declared()) {
+		Tokid t = f->get_tokid();
+		w.key("declaration").begin_object()
+		    .member("file", t.get_fileid().get_id())
+		    .member("path", t.get_fileid().get_path())
+		    .member("line", Filedetails::get_line_number(t.get_fileid(), t.get_streampos()))
+		    .end_object();
+	}
+	if (f->is_defined()) {
+		Tokid t = f->get_definition();
+		w.key("definition").begin_object()
+		    .member("file", t.get_fileid().get_id())
+		    .member("path", t.get_fileid().get_path())
+		    .member("line", Filedetails::get_line_number(t.get_fileid(), t.get_streampos()))
+		    .end_object();
+	}
+	w.key("calls").begin_array();
+	for (Call::const_fiterator_type i = f->call_begin(); i != f->call_end(); i++)
+		json_function(w, *i);
+	w.end_array();
+	w.key("callers").begin_array();
+	for (Call::const_fiterator_type i = f->caller_begin(); i != f->caller_end(); i++)
+		json_function(w, *i);
+	w.end_array();
+	if (f->is_defined())
+		json_metrics<FunMetrics>(w, f->get_pre_cpp_const_metrics(), f->get_post_cpp_const_metrics());
+	w.end_object();
+	return 0;
+}
+
+/*
+ * Functions associated with a given one, taking the parameters of
+ * funlist.html: n is d or u for the directly called or calling
+ * functions, and D or U for all of them.
+ */
+static int
+funlist_json_page(FILE *of, void *)
+{
+	json_content();
+	Call *f;
+	char *ltype = swill_getvar("n");
+	if (!swill_getargs("p(f)", &f) || !ltype) {
+		json_error(of, "Missing value");
+		return 0;
+	}
+	Call::const_fiterator_type (Call::*fbegin)() const;
+	Call::const_fiterator_type (Call::*fend)() const;
+	switch (*ltype) {
+	case 'u': case 'U':
+		fbegin = &Call::caller_begin;
+		fend = &Call::caller_end;
+		break;
+	case 'd': case 'D':
+		fbegin = &Call::call_begin;
+		fend = &Call::call_end;
+		break;
+	default:
+		json_error(of, "Illegal value");
+		return 0;
+	}
+	JsonWriter w(of);
+	w.begin_object().key("functions").begin_array();
+	QueryBudget::start();
+	if (isupper(*ltype)) {
+		Call::clear_visit_flags();
+		visit_functions(NULL, NULL, f, fbegin, fend, true, false, Option::cgraph_depth->get());
+		for (Call::const_fmap_iterator_type i = Call::fbegin(); i != Call::fend(); i++)
+			if (i->second != f && i->second->is_visited())
+				json_function(w, i->second);
+	} else
+		for (Call::const_fiterator_type i = (f->*fbegin)(); i != (f->*fend)(); i++)
+			json_function(w, *i);
+	w.end_array();
+	json_truncated(w);
+	w.end_object();
+	return 0;
+}
+
+// Details of a file, as in file.html
+static int
+file_json_page(FILE *of, void *)
+{
+	json_content();
+	int id;
+	if (!swill_getargs("i(id)", &id)) {
+		json_error(of, "Missing value");
+		return 0;
+	}
+	Fileid fi(id);
+	JsonWriter w(of);
+	w.begin_object()
+	    .member("id", fi.get_id())
+	    .member("path", fi.get_path())
+	    .member("readonly", fi.get_readonly())
+	    .member("hand_edited", Filedetails::is_hand_edited(fi));
+	json_projects(w, [fi](Attributes::size_type j) { return Filedetails::get_attribute(fi, j); });
+	w.key("identical_files").begin_array();
+	for (Fileid f : Filedetails::get_identical_files(fi))
+		if (f != fi)
+			w.value(f.get_id());
+	w.end_array();
+	json_metrics<FileMetrics>(w, Filedetails::get_pre_cpp_const_metrics(fi),
+	    Filedetails::get_post_cpp_metrics(fi), true);
+	w.end_object();
+	return 0;
+}
+
 // Front-end global options page
 static int
 options_page(FILE *fo, void *)
@@ -1377,6 +2170,8 @@ set_options_page(FILE *fo, void *p)
 		return 0;
 	}
 	Option::set_all();
+	// Options affect the matching and ordering of query results
+	QueryCacheBase::invalidate();
 	if (Option::sfile_re_string->get().length()) {
 		string error_msg;
 		if (!engine.set_sfile_re(Option::sfile_re_string->get(), error_msg)) {
@@ -1504,10 +2299,10 @@ single_function_graph()
  * Return true if the include/global/call graph is specified for a single file.
  * In this case caller will only show entries that have the visited flag set, so
  * set this flag as specified.
- * For function * call graphs also fill edges with a matrix indicating the dges to draw
+ * For function * call graphs also fill edges with the edges to draw
  */
 static bool
-single_file_graph(char gtype, EdgeMatrix &edges)
+single_file_graph(char gtype, FileEdges &edges)
 {
 	int id;
 	char *ltype = swill_getvar("n");
@@ -1548,8 +2343,6 @@ single_file_graph(char gtype, EdgeMatrix &edges)
 		}
 		break;
 	case 'F':		// Function call graph (control dependency)
-		int size = Fileid::max_id() + 1;
-		edges.insert(edges.begin(), size, vector<bool>(size, 0));
 		switch (*ltype) {
 		case 'D':
 			visit_fcall_files(fileid, &Call::call_begin, &Call::call_end, Option::cgraph_depth->get(), edges);
@@ -1588,6 +2381,7 @@ static int
 cgraph_page(GraphDisplay *gd)
 {
 	bool all, only_visited;
+	graph_budget_start(gd);
 	if (gd->uses_swill) {
 		all = !!swill_getvar("all");
 		only_visited = (single_function_graph() || single_file_function_graph());
@@ -1607,7 +2401,7 @@ cgraph_page(GraphDisplay *gd)
 		if (only_visited && !fun->second->is_visited())
 			continue;
 		gd->node(fun->second);
-		if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
+		if (graph_limit(count))
 			goto end;
 	}
 	// Now the edges
@@ -1624,11 +2418,12 @@ cgraph_page(GraphDisplay *gd)
 			if (only_visited && !((*call)->get_visited() & fun->second->get_visited()))
 				continue;
 			gd->edge(fun->second, *call);
-			if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
+			if (graph_limit(count))
 				goto end;
 		}
 	}
 end:
+	graph_truncated(gd);
 	gd->tail();
 	return 0;
 }
@@ -1640,6 +2435,7 @@ fgraph_page(GraphDisplay *gd)
 
 	const char *gtype = NULL;
 	const char *ltype = NULL;
+	graph_budget_start(gd);
 	if (gd->uses_swill) {
 		gtype = swill_getvar("gtype");		// Graph type
 		ltype = swill_getvar("n");
@@ -1654,7 +2450,7 @@ fgraph_page(GraphDisplay *gd)
 		return 0;
 	}
 	bool all, only_visited;
-	EdgeMatrix edges;
+	FileEdges edges;
 	bool empty_node = (Option::fgraph_show->get() == 'e');
 	if (gd->uses_swill) {
 		all = !!swill_getvar("all");		// Otherwise exclude read-only files
@@ -1678,8 +2474,6 @@ fgraph_page(GraphDisplay *gd)
 	case 'F':		// Function call graph (control dependency)
 		gd->head("fgraph", "Function Call (Control) Dependency Graph", empty_node);
 		if (!only_visited) {
-			int size = Fileid::max_id() + 1;
-			edges.insert(edges.begin(), size, vector<bool>(size, 0));
 			// Fill the edges for all files
 			Filedetails::clear_all_visited();
 			for (const auto &file : engine.get_files()) {
@@ -1712,7 +2506,7 @@ fgraph_page(GraphDisplay *gd)
 		if (only_visited && !Filedetails::is_visited(file))
 			continue;
 		gd->node(file);
-		if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
+		if (graph_limit(count))
 			goto end;
 	}
 	// Now the edges
@@ -1735,13 +2529,16 @@ fgraph_page(GraphDisplay *gd)
 				if (only_visited && !Filedetails::is_visited(j->first))
 					continue;
 				gd->edge(j->first, file);
-				if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
+				if (graph_limit(count))
 					goto end;
 			}
 			break;
 		}
-		case 'F':		// Function call graph (control dependency)
-			for (const auto &file2 : engine.get_files()) {				
+		case 'F': {		// Function call graph (control dependency)
+			FileEdges::const_iterator e = edges.find(file);
+			if (e == edges.end())
+				break;
+			for (const auto &file2 : e->second) {
 				if (!all && file2.get_readonly())
 					continue;
 				if (only_visited && !Filedetails::is_visited(file2))
@@ -1749,20 +2546,20 @@ fgraph_page(GraphDisplay *gd)
 				if (file == file2)
 					continue;
 				if (DP())
-					cout << "Checking " << file.get_fname() << " - " << file2.get_fname() << endl;
-				if (edges[file.get_id()][file2.get_id()])
-					switch (*ltype) {
-					case 'D':
-						gd->edge(file2, file);
-						break;
-					case 'U':
-						gd->edge(file, file2);
-						break;
-					}
-				if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
+					cout << "Edge " << file.get_fname() << " - " << file2.get_fname() << endl;
+				switch (*ltype) {
+				case 'D':
+					gd->edge(file2, file);
+					break;
+				case 'U':
+					gd->edge(file, file2);
+					break;
+				}
+				if (graph_limit(count))
 					goto end;
 			}
 			break;
+		}
 		case 'G':		// Global object def/ref graph (data dependency)
 			for (Fileidset::const_iterator j = Filedetails::get_glob_uses(file).begin(); j != Filedetails::get_glob_uses(file).end(); j++) {
 				if (!all && j->get_readonly())
@@ -1770,7 +2567,7 @@ fgraph_page(GraphDisplay *gd)
 				if (only_visited && !Filedetails::is_visited(*j))
 					continue;
 				gd->edge(*j, file);
-				if (browse_only && count++ >= MAX_BROWSING_GRAPH_ELEMENTS)
+				if (graph_limit(count))
 					goto end;
 			}
 			break;
@@ -1780,6 +2577,7 @@ fgraph_page(GraphDisplay *gd)
 		}
 	}
 end:
+	graph_truncated(gd);
 	gd->tail();
 	return 0;
 }
@@ -1818,6 +2616,16 @@ graph_html_page(FILE *fo, void (*graph_fun)(GraphDisplay *))
 	return 0;
 }
 
+// Graph: JSON
+static int
+graph_json_page(FILE *fo, void (*graph_fun)(GraphDisplay *))
+{
+	json_content();
+	GDJson gd(fo);
+	graph_fun(&gd);
+	return 0;
+}
+
 // Graph: dot
 static int
 graph_dot_page(FILE *fo, void (*graph_fun)(GraphDisplay *))
@@ -1948,13 +2756,28 @@ produce_call_graphs(const vector <string> &call_graphs)
 }
 
 
+/*
+ * Register a page that can also be evaluated as a background job.
+ * In browse-only mode each request is already served by a separate
+ * process, so the page is always evaluated directly.
+ */
+static void
+bg_handle(const char *url, const char *title, SwillHandler h, void *data = NULL)
+{
+	if (opts.browse_only)
+		swill_handle(url, h, data);
+	else
+		job_handle(url, title, h, data);
+}
+
 // Setup graph handling for all supported graph output types
 static void
 graph_handle(string name, int (*graph_fun)(GraphDisplay *))
 {
-	swill_handle((name + ".html").c_str(), graph_html_page, graph_fun);
+	bg_handle((name + ".html").c_str(), "Graph", SH(graph_html_page), (void *)graph_fun);
 	swill_handle((name + ".txt").c_str(), graph_txt_page, graph_fun);
 	swill_handle((name + "_dot.txt").c_str(), graph_dot_page, graph_fun);
+	swill_handle((name + ".json").c_str(), graph_json_page, graph_fun);
 	swill_handle((name + ".svg").c_str(), graph_svg_page, graph_fun);
 	swill_handle((name + ".gif").c_str(), graph_gif_page, graph_fun);
 	swill_handle((name + ".png").c_str(), graph_png_page, graph_fun);
@@ -1986,6 +2809,7 @@ set_project_page(FILE *fo, void *p)
 		fprintf(fo, "Missing value");
 		return 0;
 	}
+	QueryCacheBase::invalidate();
 	index_page(fo, p);
 	return 0;
 }
@@ -2000,6 +2824,46 @@ about_page(FILE *fo, void *)
 	return 0;
 }
 
+// Display the memory used by the major data structures
+static int
+memory_page(FILE *of, void *)
+{
+	html_head(of, "memory", "Memory Use");
+	if (swill_getvar("dump")) {
+		if (opts.browse_only) {
+			html_error(of, "Heap profiles can not be dumped in browse-only mode");
+			return 0;
+		}
+		if (heap_profile_dump("cscout.heap"))
+			fputs("<p>Heap profile dumped.</p>\n", of);
+		else
+			fputs("<p>Unable to dump the heap profile.</p>\n", of);
+	}
+	MemoryStats ms(MemoryStats::collect());
+	fputs("<table class='metrics'>\n<tr>"
+	    "<th>Data structure</th>"
+	    "<th>Elements</th>"
+	    "<th>Estimated bytes</th>"
+	    "</tr>\n", of);
+	for (const MemoryStats::Entry &e : ms)
+		fprintf(of, "<tr><td>%s</td><td align='right'>%zu</td>"
+		    "<td align='right'>%zu</td></tr>\n",
+		    e.name.c_str(), e.count, e.bytes);
+	fprintf(of, "<tr><td>Total</td><td></td>"
+	    "<td align='right'>%zu</td></tr>\n", ms.total_bytes());
+	size_t heap = heap_in_use();
+	if (heap)
+		fprintf(of, "<tr><td>Heap in use</td><td></td>"
+		    "<td align='right'>%zu</td></tr>\n", heap);
+	fputs("</table>\n", of);
+	fputs("<p>The estimates do not include allocator overhead and "
+	    "fragmentation.</p>\n", of);
+	if (heap_profile_available() && !opts.browse_only)
+		fputs("<p><a href=\"memory.html?dump=1\">Dump a heap profile</a></p>\n", of);
+	html_tail(of);
+	return 0;
+}
+
 
 // Index
 static int
@@ -2080,7 +2944,7 @@ index_page(FILE *of, void *)
 	);
 
 
-	if (!browse_only)
+	if (!opts.browse_only)
 		fputs(
 			"<div class=\"mainblock\">\n"
 			"<h2>Operations</h2>"
@@ -2091,6 +2955,8 @@ index_page(FILE *of, void *)
 			"<li> <a href=\"funargrefs.html\">Function argument refactorings</a>\n"
 			"<li> <a href=\"sproject.html\">Select active project</a>\n"
 			"<li> <a href=\"about.html\">About CScout</a>\n"
+			"<li> <a href=\"memory.html\">Memory use</a>\n"
+			"<li> <a href=\"jobs.html\">Background jobs</a>\n"
 			"<li> <a href=\"save.html\">Save changes and continue</a>\n"
 			"<li> <a href=\"sexit.html\">Exit &mdash; saving changes</a>\n"
 			"<li> <a href=\"qexit.html\">Exit &mdash; ignore changes</a>\n"
@@ -2142,7 +3008,7 @@ file_page(FILE *of, void *)
 	fprintf(of, "<li> <a href=\"qsrc.html?qt=id&id=%u&match=L&writable=1&a%d=1&n=Source+Code+With+Hyperlinks+to+Project-global+Writable+Identifiers\">Source code with hyperlinks to project-global writable identifiers</a>\n", i.get_id(), is_lscope);
 	fprintf(of, "<li> <a href=\"qsrc.html?qt=id&id=%u&match=L&writable=1&a%d=1&n=Source+Code+With+Hyperlinks+to+File-local+Writable+Identifiers\">Source code with hyperlinks to file-local writable identifiers</a>\n", i.get_id(), is_cscope);
 	fprintf(of, "<li> <a href=\"qsrc.html?qt=fun&id=%u&match=Y&writable=1&ro=1&n=Source+Code+With+Hyperlinks+to+Function+and+Macro+Declarations\">Source code with hyperlinks to function and macro declarations</a>\n", i.get_id());
-	if (modification_state != ms_subst && !browse_only)
+	if (modification_state != ms_subst && !opts.browse_only)
 		fprintf(of, "<li> <a href=\"fedit.html?id=%u\">Edit the file</a>", i.get_id());
 
 	fprintf(of, "</ul>\n<h2>Functions</h2><ul>\n");
@@ -2218,6 +3084,30 @@ file_page(FILE *of, void *)
 	return 0;
 }
 
+/*
+ * Output through page_fn a page that can be large, such as source code,
+ * compressing it if the client accepts gzip content encoding.
+ */
+static void
+compressed_page(FILE *of, const function <void(FILE *)> &page_fn)
+{
+#if defined(HAVE_ZLIB) && !defined(WIN32)
+	if (html_accepts_gzip()) {
+		char *page = NULL;
+		size_t len = 0;
+		FILE *pf = open_memstream(&page, &len);
+		if (pf) {
+			page_fn(pf);
+			fclose(pf);
+			html_gzip(of, page, len);
+			free(page);
+			return;
+		}
+	}
+#endif
+	page_fn(of);
+}
+
 static int
 source_page(FILE *of, void *)
 {
@@ -2228,9 +3118,11 @@ source_page(FILE *of, void *)
 	}
 	Fileid i(id);
 	const string &pathname = i.get_path();
-	html_head(of, "src", string("Source: ") + html(pathname));
-	file_hypertext(of, i, false);
-	html_tail(of);
+	compressed_page(of, [&](FILE *pf) {
+		html_head(pf, "src", string("Source: ") + html(pathname));
+		file_hypertext(pf, i, false);
+		html_tail(pf);
+	});
 	return 0;
 }
 
@@ -2251,6 +3143,7 @@ fedit_page(FILE *of, void *)
 	}
 	Fileid i(id);
 	Filedetails::set_hand_edited(i);
+	QueryCacheBase::invalidate();
 	char *re = swill_getvar("re");
 	char buff[4096];
 	snprintf(buff, sizeof(buff), Option::start_editor_cmd ->get().c_str(), (re ? re : "^"), i.get_path().c_str());
@@ -2277,13 +3170,15 @@ query_source_page(FILE *of, void *)
 	Fileid i(id);
 	const string &pathname = i.get_path();
 	char *qname = swill_getvar("n");
-	if (qname && *qname)
-		html_head(of, "qsrc", string(qname) + ": " + html(pathname));
-	else
-		html_head(of, "qsrc", string("Source with queried elements marked: ") + html(pathname));
-	fputs("<p>Use the tab key to move to each marked element.</p>", of);
-	file_hypertext(of, i, true);
-	html_tail(of);
+	compressed_page(of, [&](FILE *pf) {
+		if (qname && *qname)
+			html_head(pf, "qsrc", string(qname) + ": " + html(pathname));
+		else
+			html_head(pf, "qsrc", string("Source with queried elements marked: ") + html(pathname));
+		fputs("<p>Use the tab key to move to each marked element.</p>", pf);
+		file_hypertext(pf, i, true);
+		html_tail(pf);
+	});
 	return 0;
 }
 
@@ -2320,8 +3215,8 @@ query_include_page(FILE *of, void *)
 			html_file(of, f2);
 			if (id.is_directly_included()) {
 				fprintf(of, "<td>line ");
-				const set <int> &lines = id.include_line_numbers();
-				for (set <int>::const_iterator j = lines.begin(); j != lines.end(); j++)
+				const IncDetails::line_container &lines = id.include_line_numbers();
+				for (IncDetails::line_container::const_iterator j = lines.begin(); j != lines.end(); j++)
 					fprintf(of, " <a href=\"src.html?id=%u#%d\">%d</a> ", (includes ? f : f2).get_id(), *j, *j);
 				if (!id.is_required())
 					fprintf(of, " (not required)");
@@ -2401,6 +3296,7 @@ xreplacements_page(FILE *of,  void *p)
 	}
 	if (!opts.is_quiet())
 	    cerr << endl;
+	QueryCacheBase::invalidate();
 	index_page(of, p);
 	return 0;
 }
@@ -2482,7 +3378,7 @@ write_quit_page(FILE *of, void *exit)
 		progress(i, ids);
 		if (i->second.get_replaced() && i->second.get_active()) {
 			Eclass *e = (*i).first;
-			IFSet ifiles = e->sorted_files();
+			const vector <Fileid> &ifiles = e->sorted_files();
 			process.insert(ifiles.begin(), ifiles.end());
 		}
 	}
@@ -2518,7 +3414,7 @@ write_quit_page(FILE *of, void *exit)
 		if (!i->second.is_active())
 			continue;
 		Eclass *e = i->first;
-		IFSet ifiles = e->sorted_files();
+		const vector <Fileid> &ifiles = e->sorted_files();
 		process.insert(ifiles.begin(), ifiles.end());
 	}
 	if (!opts.is_quiet())
@@ -2605,7 +3501,71 @@ public:
 	bool is_required() const { return required; }
 };
 
-// Generate a warning report
+/*
+ * Return the unneeded include file warnings of a compilation unit.
+ * The hard work has already been done by Fdep::mark_required()
+ * Here we do some additional processing, because
+ * a given include directive can include different files on different
+ * compilations (through different include paths or macros)
+ * Therefore maintain a map for include directive site information:
+ */
+static vector <string>
+unused_include_warnings(Fileid file)
+{
+	typedef map <int, SiteInfo> Sites;
+	Sites include_sites;
+	vector <string> warnings;
+
+	if (file.get_readonly() ||		// Don't report on RO files
+	    !Filedetails::is_compilation_unit(file) ||		// Algorithm only works for CUs
+	    file == engine.get_input_file_id() ||		// Don't report on main file
+	    Filedetails::get_includers(file).size() > 1)	// For files that are both CUs and included
+						// by others all bets are off
+		return warnings;
+	const FileIncMap &m = Filedetails::get_includes(file);
+	// Find the status of our include sites
+	for (FileIncMap::const_iterator j = m.begin(); j != m.end(); j++) {
+		Fileid f2 = (*j).first;
+		const IncDetails &id = (*j).second;
+		if (!id.is_directly_included())
+			continue;
+		const IncDetails::line_container &lines = id.include_line_numbers();
+		for (IncDetails::line_container::const_iterator k = lines.begin(); k != lines.end(); k++) {
+			Sites::iterator si = include_sites.find(*k);
+			if (si == include_sites.end())
+				include_sites.insert(Sites::value_type(*k, SiteInfo(id.is_required(), f2)));
+			else
+				(*si).second.update(id.is_required(), f2);
+		}
+	}
+	// And report those containing unused files
+	Sites::const_iterator si;
+	for (si = include_sites.begin(); si != include_sites.end(); si++)
+		if (!(*si).second.is_required()) {
+			const set <Fileid> &sf = (*si).second.get_files();
+			int line = (*si).first;
+			for (set <Fileid>::const_iterator fi = sf.begin(); fi != sf.end(); fi++) {
+				ostringstream w;
+				w << file.get_path() << ':' <<
+					line << ": " <<
+					"(" << Filedetails::get_pre_cpp_const_metrics(file).get_int_metric(Metrics::em_nuline) << " unprocessed lines)"
+					" unused included file " <<
+					fi->get_path();
+				warnings.push_back(w.str());
+			}
+		}
+	return warnings;
+}
+
+/*
+ * Generate a warning report
+ * The identifiers and the files are divided into consecutive parts,
+ * which are processed in parallel.  Each part collects its warnings,
+ * which are then output in the order of the parts, so that the
+ * report is the same as the one produced by sequential processing:
+ * the identifier warnings grouped by report, followed by the include
+ * file warnings.
+ */
 static void
 warning_report()
 {
@@ -2622,74 +3582,61 @@ warning_report()
 		{ "writable identifier should be made static",
 		  "T:writable:obj:pscope" }, // xfile is implicitly 0
 	};
+	const int nreports = sizeof(reports) / sizeof(reports[0]);
 
-	// Generate identifier warnings
-	for (unsigned i = 0; i < sizeof(reports) / sizeof(reports[0]); i++) {
-		IdQuery query(reports[i].query);
-
-		csassert(query.is_valid());
-		for (IdProp::iterator j = ids.begin(); j != ids.end(); j++) {
-			if (!query.eval(*j))
-				continue;
-			const Tokid t = *((*j).first->get_members().begin());
-			const string &id = (*j).second.get_id();
-			cerr << t.get_path() << ':' <<
-				Filedetails::get_line_number(t.get_fileid(), t.get_streampos()) << ": " <<
-				id << ": " << reports[i].message << endl;
-		}
+	vector <IdQuery> queries;
+	for (int r = 0; r < nreports; r++) {
+		queries.emplace_back(reports[r].query);
+		csassert(queries.back().is_valid());
 	}
 
-	/*
-	 * Generate unneeded include file warnings
-	 * The hard work has already been done by Fdep::mark_required()
-	 * Here we do some additional processing, because
-	 * a given include directive can include different files on different
-	 * compilations (through different include paths or macros)
-	 * Therefore maintain a map for include directive site information:
-	 */
-
-	typedef map <int, SiteInfo> Sites;
-	Sites include_sites;
-
-	for (const auto &file : engine.get_files()) {
-		if (file.get_readonly() ||		// Don't report on RO files
-		    !Filedetails::is_compilation_unit(file) ||		// Algorithm only works for CUs
-		    file == engine.get_input_file_id() ||		// Don't report on main file
-		    Filedetails::get_includers(file).size() > 1)	// For files that are both CUs and included
-							// by others all bets are off
-			continue;
-		const FileIncMap &m = Filedetails::get_includes(file);
-		// Find the status of our include sites
-		include_sites.clear();
-		for (FileIncMap::const_iterator j = m.begin(); j != m.end(); j++) {
-			Fileid f2 = (*j).first;
-			const IncDetails &id = (*j).second;
-			if (!id.is_directly_included())
-				continue;
-			const set <int> &lines = id.include_line_numbers();
-			for (set <int>::const_iterator k = lines.begin(); k != lines.end(); k++) {
-				Sites::iterator si = include_sites.find(*k);
-				if (si == include_sites.end())
-					include_sites.insert(Sites::value_type(*k, SiteInfo(id.is_required(), f2)));
-				else
-					(*si).second.update(id.is_required(), f2);
+	// Generate identifier warnings, evaluating all reports in one pass
+	vector <const IdPropElem *> elems;
+	elems.reserve(ids.size());
+	for (const IdPropElem &i : ids)
+		elems.push_back(&i);
+	unsigned parts = parallel_part_count(elems.size(), 1000);
+	// Warnings by part and report
+	vector <vector <vector <string> > > id_warnings(parts,
+	    vector <vector <string> >(nreports));
+	parallel_for_parts(parts, elems.size(), [&](unsigned p, size_t begin, size_t end) {
+		/*
+		 * The queries are shared: their evaluation does not modify
+		 * them, whereas copying them would update the unsynchronized
+		 * reference counts of their compiled REs.
+		 */
+		for (size_t n = begin; n < end; n++) {
+			const IdPropElem &i = *elems[n];
+			for (int r = 0; r < nreports; r++) {
+				if (!queries[r].eval(i))
+					continue;
+				const Tokid t = *(i.first->get_members().begin());
+				ostringstream w;
+				w << t.get_path() << ':' <<
+					Filedetails::get_line_number(t.get_fileid(), t.get_streampos()) << ": " <<
+					i.second.get_id() << ": " << reports[r].message;
+				id_warnings[p][r].push_back(w.str());
 			}
 		}
-		// And report those containing unused files
-		Sites::const_iterator si;
-		for (si = include_sites.begin(); si != include_sites.end(); si++)
-			if (!(*si).second.is_required()) {
-				const set <Fileid> &sf = (*si).second.get_files();
-				int line = (*si).first;
-				for (set <Fileid>::const_iterator fi = sf.begin(); fi != sf.end(); fi++)
-					cerr << file.get_path() << ':' <<
-						line << ": " <<
-						"(" << Filedetails::get_pre_cpp_const_metrics(file).get_int_metric(Metrics::em_nuline) << " unprocessed lines)"
-						" unused included file " <<
-						fi->get_path() <<
-						endl;
-			}
-	}
+	});
+	for (int r = 0; r < nreports; r++)
+		for (unsigned p = 0; p < parts; p++)
+			for (const string &w : id_warnings[p][r])
+				cerr << w << endl;
+
+	// Generate unneeded include file warnings
+	const vector <Fileid> &files = engine.get_files();
+	parts = parallel_part_count(files.size(), 100);
+	vector <vector <string> > inc_warnings(parts);
+	parallel_for_parts(parts, files.size(), [&](unsigned p, size_t begin, size_t end) {
+		for (size_t n = begin; n < end; n++) {
+			vector <string> w(unused_include_warnings(files[n]));
+			inc_warnings[p].insert(inc_warnings[p].end(), w.begin(), w.end());
+		}
+	});
+	for (const vector <string> &part : inc_warnings)
+		for (const string &w : part)
+			cerr << w << endl;
 }
 
 
@@ -2749,6 +3696,126 @@ merge_tokens(char **argv)
 	exit(0);
 }
 
+#ifndef WIN32
+// A browse-only worker process
+struct Worker {
+	pid_t pid;		// Process id; 0 if it is not running
+	time_t started;		// Time the process was started
+};
+static vector <Worker> workers;
+
+// Workers terminating earlier than this (in seconds) have failed to start
+#define WORKER_MIN_LIFETIME 10
+// Consecutive failures after which the server gives up
+#define WORKER_MAX_FAILURES 5
+
+// Terminate the worker processes together with their parent
+[[noreturn]] static void
+terminate_workers(int sig)
+{
+	for (const Worker &w : workers)
+		if (w.pid > 0)
+			kill(w.pid, SIGTERM);
+	_exit(sig == SIGTERM ? 0 : 1);
+}
+
+/*
+ * Serve browse-only requests through n pre-forked worker processes.
+ * Each worker accepts connections on the shared listening socket and
+ * handles them sequentially.  This avoids the cost of forking the
+ * (large) process for every request, while allowing multiple
+ * users to be served concurrently.  Browse-only requests cannot
+ * modify the workspace, so the workers need not coordinate.
+ * Workers that die are restarted.  Workers that die soon after
+ * their start are restarted after an increasing delay, and
+ * if this keeps happening the server exits, rather than
+ * repeatedly forking processes that cannot run.
+ * The function does not return.
+ */
+static void
+serve_workers(int n)
+{
+	int failures = 0;		// Consecutive early worker terminations
+
+	workers.resize(n);
+	signal(SIGTERM, terminate_workers);
+	signal(SIGINT, terminate_workers);
+	for (;;) {
+		for (Worker &w : workers) {
+			if (w.pid > 0)
+				continue;
+			w.started = time(NULL);
+			switch (w.pid = fork()) {
+			case -1:
+				perror("fork");
+				terminate_workers(SIGINT);
+				/* NOTREACHED */
+			case 0:
+				signal(SIGTERM, SIG_DFL);
+				signal(SIGINT, SIG_DFL);
+				for (;;)
+					swill_serve();
+			}
+		}
+		int status;
+		pid_t pid = wait(&status);
+		if (pid == -1) {
+			if (errno == EINTR)
+				continue;
+			perror("wait");
+			terminate_workers(SIGINT);
+		}
+		for (Worker &w : workers) {
+			if (w.pid != pid)
+				continue;
+			w.pid = 0;
+			if (time(NULL) - w.started >= WORKER_MIN_LIFETIME) {
+				failures = 0;
+				cerr << "Worker process " << pid << " terminated; restarting it" << endl;
+				break;
+			}
+			if (++failures == WORKER_MAX_FAILURES) {
+				cerr << "Worker processes keep terminating after their start; exiting" << endl;
+				terminate_workers(SIGINT);
+			}
+			cerr << "Worker process " << pid << " terminated after its start; "
+			    "restarting it in " << failures << "s" << endl;
+			sleep(failures);
+			break;
+		}
+	}
+}
+#endif
+
+/*
+ * Once the source code has been processed and its files analyzed,
+ * the parser's state is no longer needed and the analysis structures
+ * are mostly read.  Release the first and compact the second into
+ * sorted vectors, recording the memory reclaimed in the profiling report.
+ */
+static void
+freeze_structures()
+{
+	size_t before = 0;
+	if (Profile::is_enabled())
+		before = MemoryStats::collect().total_bytes();
+
+	Pdtoken::release();
+	Block::clear();
+	Tokid::freeze();
+	Eclass::freeze();
+	Call::freeze();
+	GlobObj::freeze();
+	Filedetails::freeze();
+	ids.freeze();
+
+	if (Profile::is_enabled()) {
+		size_t after = MemoryStats::collect().total_bytes();
+		if (before > after)
+			Profile::count(Profile::pc_bytes_reclaimed, before - after);
+	}
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -2784,11 +3851,18 @@ main(int argc, char *argv[])
 		parse_acl();
 	}
 
+	// Call graphs are output through the pages' code, which uses the options
+	if (opts.process_mode == CscoutOptions::pm_call_graph)
+		Option::initialize();
+
 	if (opts.process_mode == CscoutOptions::pm_database) {
 		if (!Sql::setEngine(opts.db_engine))
 			return 1;
-		cout << Sql::getInterface()->begin_commands();
-		workdb_schema(Sql::getInterface(), cout);
+		Sql *db = Sql::getInterface();
+		ostringstream schema;
+		workdb_schema(db, schema);
+		db->execute(cout, db->begin_commands());
+		db->execute(cout, schema.str());
 	}
 
 	Project::set_current_project("unspecified");
@@ -2805,15 +3879,27 @@ main(int argc, char *argv[])
 	while (t.get_code() != EOF);
 	Error::set_parsing(false);
 
-	if (opts.process_mode == CscoutOptions::pm_preprocess)
+	if (opts.process_mode == CscoutOptions::pm_preprocess) {
+		Profile::write_report();
 		return 0;
+	}
 
 	engine.set_input_file_id(Fileid(argv[optind]));
 
-	Filedetails::unify_identical_files();
+	{
+		Profile::Phase p("unify_identical_files");
+		Filedetails::unify_identical_files();
+	}
 
-	if (opts.process_mode == CscoutOptions::pm_obfuscation)
-		return obfuscate();
+	if (opts.process_mode == CscoutOptions::pm_obfuscation) {
+		int r;
+		{
+			Profile::Phase p("obfuscate");
+			r = obfuscate();
+		}
+		Profile::write_report();
+		return r;
+	}
 
 	// Pass 2: Create web pages
 	engine.collect_active_files();
@@ -2838,40 +3924,79 @@ main(int argc, char *argv[])
 	 * Populate the EC identifier member and the directory tree.
 	 * Set several file and function metrics.
 	 */
-	Call::populate_macro_map();
-	for (const auto &file : engine.get_files()) {
-		engine.file_analyze(file);
-		dir_add_file(file);
+	{
+		Profile::Phase p("file_analyze");
+		Call::populate_macro_map();
+		for (const auto &file : engine.get_files()) {
+			engine.file_analyze(file);
+			dir_add_file(file);
+		}
+	}
+
+	// The file analysis is the last phase to add or remove ECs
+	if (opts.freeze) {
+		Profile::Phase p("freeze");
+		freeze_structures();
 	}
 
 	// Update file and function metrics
-	file_msum.summarize_files();
-	fun_msum.summarize_functions();
+	{
+		Profile::Phase p("summarize_files");
+		file_msum.summarize_files();
+		fun_msum.summarize_functions();
+	}
 
 	// Set runtime file dependencies
-	GlobObj::set_file_dependencies();
+	{
+		Profile::Phase p("set_file_dependencies");
+		GlobObj::set_file_dependencies();
+	}
 
 	// Set xfile and  metrics for each identifier
 	if (!opts.is_quiet())
 	    cerr << "Processing identifiers" << endl;
-	for (IdProp::iterator i = ids.begin(); i != ids.end(); i++) {
-		progress(i, ids);
-		Eclass *e = (*i).first;
-		IFSet ifiles = e->sorted_files();
-		(*i).second.set_xfile(ifiles.size() > 1);
-		// Update metrics
-		id_msum.add_unique_id(e);
+	{
+		Profile::Phase p("identifiers");
+		for (IdProp::iterator i = ids.begin(); i != ids.end(); i++) {
+			progress(i, ids);
+			Eclass *e = (*i).first;
+			(*i).second.set_xfile(e->crosses_files());
+			// Update metrics
+			id_msum.add_unique_id(e);
+		}
 	}
 	if (!opts.is_quiet())
 	    cerr << endl;
 
+	/*
+	 * Index names for the regular expression queries, and
+	 * the members of each project for project-restricted queries
+	 */
+	if (opts.is_web_server_mode()) {
+		Profile::Phase p("build_index");
+		IdQuery::build_index();
+		FunQuery::build_index();
+		Query::build_file_index();
+		ProjectIndex::build(engine.get_files());
+	}
+
 	if (DP())
 		cout << "Size " << file_msum.get_pre_cpp_total(Metrics::em_nchar) << endl;
 
 	if (opts.process_mode == CscoutOptions::pm_database) {
-		workdb_rest(Sql::getInterface(), cout);
-		Call::dumpSql(Sql::getInterface(), cout);
-		cout << Sql::getInterface()->end_commands();
+		{
+			Profile::Phase p("sql_dump");
+			Sql *db = Sql::getInterface();
+			workdb_rest(db, cout);
+			Call::dumpSql(db, cout);
+			db->flush(cout);
+			ostringstream keys;
+			workdb_keys(db, keys);
+			db->execute(cout, keys.str());
+			db->execute(cout, db->end_commands());
+			Sql::release();
+		}
+		Profile::write_report();
 #ifdef LINUX_STAT_MONITOR
 		char buff[100];
 		snprintf(buff, sizeof(buff), "cat /proc/%u/stat >%u.stat", getpid(), getpid());
@@ -2892,20 +4017,27 @@ main(int argc, char *argv[])
 
 		// Identifier query and execution
 		swill_handle("iquery.html", iquery_page, NULL);
-		swill_handle("xiquery.html", xiquery_page, NULL);
+		bg_handle("xiquery.html", "Identifier query", xiquery_page);
 		// File query and execution
 		swill_handle("filequery.html", filequery_page, NULL);
-		swill_handle("xfilequery.html", xfilequery_page, NULL);
+		bg_handle("xfilequery.html", "File query", xfilequery_page);
 		swill_handle("qinc.html", query_include_page, NULL);
 
 		// Function query and execution
 		swill_handle("funquery.html", funquery_page, NULL);
-		swill_handle("xfunquery.html", xfunquery_page, NULL);
+		bg_handle("xfunquery.html", "Function query", xfunquery_page);
 
 		swill_handle("id.html", identifier_page, NULL);
 		swill_handle("fun.html", function_page, NULL);
-		swill_handle("funlist.html", funlist_page, NULL);
+		bg_handle("funlist.html", "Function list", funlist_page);
 		swill_handle("funmetrics.html", function_metrics_page, NULL);
+		swill_handle("xiquery.json", xiquery_json_page, NULL);
+		swill_handle("xfunquery.json", xfunquery_json_page, NULL);
+		swill_handle("xfilequery.json", xfilequery_json_page, NULL);
+		swill_handle("id.json", identifier_json_page, NULL);
+		swill_handle("fun.json", function_json_page, NULL);
+		swill_handle("funlist.json", funlist_json_page, NULL);
+		swill_handle("file.json", file_json_page, NULL);
 		swill_handle("filemetrics.html", file_metrics_page, NULL);
 		swill_handle("idmetrics.html", id_metrics_page, NULL);
 
@@ -2914,6 +4046,10 @@ main(int argc, char *argv[])
 		graph_handle("cpath", cpath_page);
 
 		swill_handle("about.html", about_page, NULL);
+		swill_handle("memory.html", memory_page, NULL);
+		swill_handle("jobs.html", jobs_page, NULL);
+		swill_handle("job.html", job_page, NULL);
+		swill_handle("job.txt", job_status_page, NULL);
 		swill_handle("setproj.html", set_project_page, NULL);
 		swill_handle("logo.png", logo_page, NULL);
 		swill_handle("index.html", index_page, 0);
@@ -2932,11 +4068,28 @@ main(int argc, char *argv[])
 
 	CTag::save();
 	if (opts.process_mode == CscoutOptions::pm_report) {
-		if (!must_exit)
+		if (!must_exit) {
+			Profile::Phase p("warning_report");
 			warning_report();
+		}
+		Profile::write_report();
+		return (0);
+	}
+
+	if (opts.process_mode == CscoutOptions::pm_call_graph) {
+		cerr << "Producing call graphs for: ";
+		for (string d : opts.call_graphs) cerr << d << " ";
+		cerr << endl;
+		{
+			Profile::Phase p("call_graphs");
+			produce_call_graphs(opts.call_graphs);
+		}
+		Profile::write_report();
 		return (0);
 	}
 
+	Profile::write_report();
+
 #ifdef PICO_QL
 	if (opts.pico_ql) {
 		pico_ql_register(&files, "files");
@@ -2949,15 +4102,6 @@ main(int argc, char *argv[])
 	}
 #endif
 
-	if (opts.process_mode == CscoutOptions::pm_call_graph) {
-		cerr << "Producing call graphs for: ";
-		for (string d : opts.call_graphs) cerr << d << " ";
-		cerr << endl;
-		produce_call_graphs(opts.call_graphs);
-
-		return (0);
-	}
-
 	if (DP())
 		cout  << "Tokid EC map size is " << Tokid::map_size() << endl;
 	if (opts.process_mode == CscoutOptions::pm_compile)
@@ -2965,7 +4109,11 @@ main(int argc, char *argv[])
 	// Serve web pages
 	if (!must_exit)
 		cerr << "CScout is now ready to serve you at http://localhost:" << opts.portno << endl;
-	if (browse_only)
+#ifndef WIN32
+	if (opts.browse_only && opts.nworkers > 0)
+		serve_workers(opts.nworkers);
+#endif
+	if (opts.browse_only)
 		swill_setfork();
 	while (!must_exit)
 		swill_serve();
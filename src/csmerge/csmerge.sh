@@ -25,6 +25,13 @@ create_empty()
   log "Create empty $name"
   rm -f "$name"
   sqlite3 file-0000.db .schema | sqlite3 "$name"
+
+  # Databases created with cscout -z store tokens and linepos in compact
+  # form.  These are read through views, but merged into standard tables.
+  if [ -n "$(sqlite3 file-0000.db "SELECT name FROM sqlite_master
+      WHERE name = 'TOKENBLOCKS'")" ] ; then
+    sqlite3 "$name" <"$LIB_DIR/expand.sql"
+  fi
   cat <<\EOF | sqlite3 "$name"
 CREATE INDEX IF NOT EXISTS idx_definers_composite ON definers(cuid, basefileid, definerid);
 CREATE INDEX IF NOT EXISTS idx_filemetrics_composite ON filemetrics(fid, precpp);
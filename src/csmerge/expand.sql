@@ -0,0 +1,26 @@
+-- Replace the compact (cscout -z) token and line position tables
+-- with the standard ones, which can be merged and indexed.
+
+CREATE TABLE tokens_expanded(
+  fid INTEGER, -- File key
+  foffset INTEGER, -- Offset within the file
+  eid BIGINT, -- Identifier key
+  PRIMARY KEY(fid, foffset)
+);
+
+INSERT INTO tokens_expanded SELECT fid, foffset, eid FROM tokens;
+DROP VIEW tokens;
+DROP TABLE tokenblocks;
+ALTER TABLE tokens_expanded RENAME TO tokens;
+
+CREATE TABLE linepos_expanded(
+  fid INTEGER, -- File key
+  foffset INTEGER, -- Offset within the file
+  lnum INTEGER, -- Line number (starts at 1)
+  PRIMARY KEY(fid, foffset)
+);
+
+INSERT INTO linepos_expanded SELECT fid, foffset, lnum FROM linepos;
+DROP VIEW linepos;
+DROP TABLE lineblocks;
+ALTER TABLE linepos_expanded RENAME TO linepos;
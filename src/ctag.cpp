@@ -53,6 +53,7 @@
 #include "type.h"
 #include "ctag.h"
 #include "version.h"
+#include "memstat.h"
 
 set<CTag> CTag::ctags;
 bool CTag::enabled;
@@ -140,3 +141,12 @@ CTag::save()
 		out << endl;
 	}
 }
+
+void
+CTag::memory_stats(MemoryStats &s)
+{
+	size_t bytes = node_bytes(ctags);
+	for (const CTag &t : ctags)
+		bytes += string_bytes(t.name) + string_bytes(t.tag);
+	s.add("Tags", ctags.size(), bytes);
+}
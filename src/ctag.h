@@ -24,6 +24,8 @@
 #ifndef CTAG_
 #define CTAG_
 
+class MemoryStats;
+
 class CTag {
 private:
 	string name;
@@ -104,6 +106,8 @@ public:
 	}
 	// Save ctags
 	static void save();
+	// Add the memory used by the tags to s
+	static void memory_stats(MemoryStats &s);
 
 	inline friend bool operator <(const class CTag &a, const class CTag &b);
 };
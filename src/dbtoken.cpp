@@ -356,18 +356,15 @@ Dbtoken::write_eclasses(const char *out_path)
 	ofstream of(out_path);
 	verify_open(out_path, of);
 
-	for (auto i = Tokid::begin_ec(); i != Tokid::end_ec(); ++i) {
-		Tokid ti(i->first);
+	Tokid::for_each_ec([&of](Tokid ti, Eclass *ec) {
 		int fid = ti.get_fileid().get_id();
 
-		Eclass *ec = i->second;
-
 		if (fid < 0) {
 			// This is a twin (negative) EC; obtain its sibling.
 			Eclass *ec_twin = twin(ti).check_ec();
 			if (ec_twin)
 				// Mirror EC exists; ignore
-				continue;
+				return true;
 			else
 				// No twin EC, output the correct fid
 				fid = -fid;
@@ -377,7 +374,8 @@ Dbtoken::write_eclasses(const char *out_path)
 		    << fid << ','
 		    << (unsigned)ti.get_streampos() << ','
 		    << ptr_offset(ec) << '\n';
-	}
+		return true;
+	});
 }
 
 // Read identifiers from in_path and set the EC attributes
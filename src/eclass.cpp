@@ -50,6 +50,7 @@
 #include "filedetails.h"
 #include "eclass.h"
 #include "call.h"
+#include "memstat.h"
 
 // Remove references to the equivalence class from the tokid map
 // Should be called when we delete the ec for good
@@ -73,6 +74,7 @@ merge_into(Eclass *dst, Eclass *src)
 		dst->add_tokid(*i);
 	dst->merge_attributes(src);
 	delete src;
+	Profile::count(Profile::pc_ec_merged);
 }
 
 /*
@@ -105,6 +107,7 @@ Eclass::split(int pos)
 	if (DP())
 		cout << "Split " << this << " pos=" << pos << *this;
 	csassert(oldchars < len);
+	Profile::count(Profile::pc_ec_split);
 	Eclass *e = new Eclass(len - oldchars);
 	for (setTokid::const_iterator i = members.begin(); i != members.end(); i++)
 		e->add_tokid(*i + oldchars);
@@ -133,6 +136,7 @@ void
 Eclass::add_tokid(Tokid t)
 {
 	members.insert(t);
+	membership.reset();
 	t.set_ec(this);
 	if (t.get_readonly()) {
 		if (DP())
@@ -150,37 +154,69 @@ void
 Eclass::remove_tokid(Tokid t)
 {
 	members.erase(t);
+	membership.reset();
 	t.erase_ec();
 }
 
-// Return a set of all files where the equivalence class appears
-IFSet
-Eclass::sorted_files()
+/*
+ * Return the cached membership details, computing the files.
+ * The cache is discarded when members are added or removed,
+ * so it is normally computed once, after all files have been processed.
+ */
+Eclass::Membership &
+Eclass::get_membership()
 {
-	set <Fileid, fname_order> r;
-	setTokid::const_iterator i;
+	if (membership)
+		return *membership;
+	membership.reset(new Membership);
+	vector <Fileid> &r = membership->files;
+	Fileid prev;
+	// Members are ordered by their Fileid; skip consecutive duplicates
+	for (setTokid::const_iterator i = members.begin(); i != members.end(); i++)
+		if (r.empty() || i->get_fileid() != prev)
+			r.push_back(prev = i->get_fileid());
+	sort(r.begin(), r.end(), fname_rank_order());
+	return *membership;
+}
 
-	for (i = members.begin(); i != members.end(); i++)
-		r.insert(i->get_fileid());
-	return (r);
+int
+Eclass::get_nfiles() const
+{
+	if (membership)
+		return membership->files.size();
+	int n = 0;
+	Fileid prev;
+	for (setTokid::const_iterator i = members.begin(); i != members.end(); i++)
+		if (n == 0 || i->get_fileid() != prev) {
+			prev = i->get_fileid();
+			n++;
+		}
+	return n;
+}
+
+// Return the files where the equivalence class appears
+const vector <Fileid> &
+Eclass::sorted_files()
+{
+	return get_membership().files;
 }
 
-// Return a set of all functions where the equivalence class appears
-set <Call *>
+// Return the functions where the equivalence class appears
+const vector <Call *> &
 Eclass::functions()
 {
-	set <Call *> r;
-	setTokid::const_iterator i;
+	Membership &m = get_membership();
+	if (m.have_functions)
+		return m.functions;
 
-	for (i = members.begin(); i != members.end(); i++) {
-		FCallSet fc(Filedetails::get_functions(i->get_fileid()));
-		for (FCallSet::const_iterator j = fc.begin(); j != fc.end(); j++)
-			if ((*j)->is_span_valid() &&
-			    *i >= (*j)->get_begin().get_tokid() &&
-			    *i <= (*j)->get_end().get_tokid())
-				r.insert(*j);
-	}
-	return (r);
+	vector <Call *> &r = m.functions;
+	for (setTokid::const_iterator i = members.begin(); i != members.end(); i++)
+		Filedetails::get_function_spans(i->get_fileid()).for_each_enclosing(*i,
+		    [&r](Call *c) { r.push_back(c); });
+	sort(r.begin(), r.end());
+	r.erase(unique(r.begin(), r.end()), r.end());
+	m.have_functions = true;
+	return r;
 }
 
 // Return true if this equivalence class is unintentionally unused
@@ -198,6 +234,43 @@ Eclass::is_unused()
 	return (false);
 }
 
+/*
+ * Every member of an equivalence class appears in the Tokid map,
+ * so visit each class through the map entry of its first member.
+ */
+void
+Eclass::memory_stats(MemoryStats &s)
+{
+	size_t n = 0, nmembers = 0, bytes = 0, member_bytes = 0;
+
+	Tokid::for_each_ec([&](Tokid t, const Eclass *e) {
+		if (*e->members.begin() != t)
+			return true;
+		n++;
+		nmembers += e->members.size();
+		member_bytes += node_bytes(e->members);
+		bytes += sizeof(Eclass);
+		if (e->membership)
+			bytes += sizeof(Membership) +
+				vector_bytes(e->membership->files) +
+				vector_bytes(e->membership->functions);
+		return true;
+	});
+	s.add("Equivalence classes", n, bytes);
+	s.add("Equivalence class members", nmembers, member_bytes);
+}
+
+void
+Eclass::freeze()
+{
+	// Visit each class once, through its first member
+	Tokid::for_each_ec([](Tokid t, Eclass *e) {
+		if (*e->members.begin() == t)
+			e->members.freeze();
+		return true;
+	});
+}
+
 #ifdef UNIT_TEST
 // cl -GX -DWIN32 -c tokid.cpp fileid.cpp
 // cl -GX -DWIN32 -DUNIT_TEST eclass.cpp tokid.obj fileid.obj kernel32.lib
@@ -27,22 +27,35 @@
 
 #include <deque>
 #include <vector>
+#include <memory>
 
 using namespace std;
 
 #include "attr.h"
 #include "tokid.h"
 #include "tokmap.h"
+#include "profile.h"
+#include "freezable.h"
 
-typedef set<Tokid> setTokid;
+typedef FreezableSet<Tokid> setTokid;
 
 class Call;
+class MemoryStats;
 
 class Eclass {
 private:
 	int len;			// Identifier length
 	setTokid members;		// Class members
 	Attributes attr;
+	// Files and functions containing the members, computed on demand
+	struct Membership {
+		vector <Fileid> files;		// In fname_order
+		vector <Call *> functions;	// In pointer order
+		bool have_functions;
+		Membership() : have_functions(false) {}
+	};
+	unique_ptr <Membership> membership;
+	Membership &get_membership();
 public:
 	// An equivalence class shall know its length
 	inline Eclass(int len);
@@ -65,10 +78,18 @@ public:
 	int get_size() { return members.size(); }
 	friend ostream& operator<<(ostream& o,const Eclass& ec);
 	const setTokid & get_members(void) const { return members; }
-	// Files where the this appears
-	IFSet sorted_files();
+	// Files where the this appears, ordered by their name
+	const vector <Fileid> &sorted_files();
+	// Return true if the class appears in more than one file
+	bool crosses_files() const {
+		// Members are ordered by their Fileid
+		return !members.empty() &&
+		    members.begin()->get_fileid() != prev(members.end())->get_fileid();
+	}
+	// Return the number of files where the class appears
+	int get_nfiles() const;
 	// Functions where the this appears
-	set <Call *> functions();
+	const vector <Call *> &functions();
 	// Other accessor functions
 	void set_attribute(int v) { attr.set_attribute(v); }
 	bool get_attribute(int v) { return attr.get_attribute(v); }
@@ -76,6 +97,10 @@ public:
 	// Return true if this equivalence class is unintentionally unused
 	bool is_unused();
 	void merge_attributes(Eclass *b) { attr.merge_with(b->attr); }
+	// Add the memory used by all equivalence classes to s
+	static void memory_stats(MemoryStats &s);
+	// Compact the members of all equivalence classes
+	static void freeze();
 	// Remove references to the equivalence class from the tokid map
 	// Should be called when we delete the ec for good
 	void remove_from_tokid_map();
@@ -85,12 +110,14 @@ inline
 Eclass::Eclass(int l)
 : len(l)
 {
+	Profile::count(Profile::pc_ec_created);
 }
 
 inline
 Eclass::Eclass(Tokid t, int l)
 : len(l)
 {
+	Profile::count(Profile::pc_ec_created);
 	add_tokid(t);
 }
 
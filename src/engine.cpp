@@ -105,8 +105,8 @@ CscoutEngine::file_analyze(Fileid fi)
 	int line_number = 0;
 
 
-	FCallSet &fc = Filedetails::get_functions(fi);	// File's functions
-	FCallSet::iterator fci = fc.begin();	// Iterator through them
+	const FunctionSpans &fc = Filedetails::get_function_spans(fi);	// File's functions
+	FunctionSpans::const_iterator fci = fc.begin();	// Iterator through them
 	Call *cfun = NULL;			// Current function
 	stack <Call *> fun_nesting;
 
@@ -142,15 +142,15 @@ CscoutEngine::file_analyze(Fileid fi)
 			}
 		}
 		// See if entering a new function
-		if (fci != fc.end() && ti >= (*fci)->get_begin().get_tokid()) {
+		if (fci != fc.end() && ti >= fci->begin) {
 			if (cfun)
 				fun_nesting.push(cfun);
-			cfun = *fci;
+			cfun = fci->fun;
 			fci++;
 		}
 
 		char c = (char)val;
-		mapTokidEclass::iterator ei;
+		Eclass *ec;
 		enum e_cfile_state cstate = Filedetails::get_pre_cpp_metrics(fi).get_state();
 
 		ma_proc.process_char(cstate, c);
@@ -160,8 +160,7 @@ CscoutEngine::file_analyze(Fileid fi)
 		    cstate != s_string &&
 		    cstate != s_cpp_comment &&
 		    (isalnum(c) || c == '_') &&
-		    (ei = ti.find_ec()) != ti.end_ec()) {
-			Eclass *ec = (*ei).second;
+		    (ec = ti.check_ec()) != NULL) {
 			// Remove identifiers we are not supposed to monitor
 			if (opts.monitor.is_valid()) {
 				IdPropElem ec_id(ec, Identifier());
@@ -690,10 +689,9 @@ CscoutEngine::garbage_collect(Fileid root)
 			ti = Tokid(fi, in.tellg());
 			if ((val = in.get()) == EOF)
 				break;
-			mapTokidEclass::iterator ei = ti.find_ec();
-			if (ei != ti.end_ec()) {
+			Eclass *ec = ti.check_ec();
+			if (ec) {
 				sum++;
-				Eclass *ec = ei->second;
 				IdPropElem ec_id(ec, Identifier());
 				if (!opts.monitor.eval(ec_id)) {
 					count++;
@@ -28,6 +28,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 
 #include "fileid.h"
 #include "compiledre.h"
@@ -59,7 +60,8 @@ public:
 	void set_active(bool a) { active = a; }
 };
 
-typedef std::vector<std::vector<bool>> EdgeMatrix;
+// Sparse file graph edges: the files each file is connected to
+typedef std::map<Fileid, std::set<Fileid, fname_rank_order>> FileEdges;
 
 // Analysis functions - defined in engine.cpp, called from cscout.cpp
 bool is_function_call_replacement_valid(std::string::const_iterator begin, std::string::const_iterator end, const char **error);
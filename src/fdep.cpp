@@ -106,43 +106,50 @@ Fdep::reset()
  * compilation unit cu
  */
 void
-Fdep::dumpSql(Sql *, ostream &of, Fileid cu)
+Fdep::dumpSql(Sql *db, ostream &of, Fileid cu)
 {
 	if (table_is_enabled(t_definers))
 		for (FSFMap::const_iterator di = definers.begin(); di != definers.end(); di++) {
 			const set <Fileid> &defs = di->second;
-			for (set <Fileid>::const_iterator i = defs.begin(); i != defs.end(); i++)
-				of << "INSERT INTO DEFINERS VALUES(" <<
-				Project::get_current_projid() << ',' <<
-				cu.get_id() << ',' <<
-				di->first.get_id() << ',' <<
-				i->get_id() << ");\n";
+			for (set <Fileid>::const_iterator i = defs.begin(); i != defs.end(); i++) {
+				db->begin_row(of, "DEFINERS");
+				db->int_value(of, Project::get_current_projid());
+				db->int_value(of, cu.get_id());
+				db->int_value(of, di->first.get_id());
+				db->int_value(of, i->get_id());
+				db->end_row(of);
+			}
 		}
 	if (table_is_enabled(t_includers))
 		for (FSFMap::const_iterator ii = includers.begin(); ii != includers.end(); ii++) {
 			const set <Fileid> &incs = ii->second;
-			for (set <Fileid>::const_iterator i = incs.begin(); i != incs.end(); i++)
-				of << "INSERT INTO INCLUDERS VALUES(" <<
-				Project::get_current_projid() << ',' <<
-				cu.get_id() << ',' <<
-				ii->first.get_id() << ',' <<
-				i->get_id() << ");\n";
+			for (set <Fileid>::const_iterator i = incs.begin(); i != incs.end(); i++) {
+				db->begin_row(of, "INCLUDERS");
+				db->int_value(of, Project::get_current_projid());
+				db->int_value(of, cu.get_id());
+				db->int_value(of, ii->first.get_id());
+				db->int_value(of, i->get_id());
+				db->end_row(of);
+			}
 		}
 	if (table_is_enabled(t_providers))
-		for (set <Fileid>::const_iterator i = providers.begin(); i != providers.end(); i++)
-			of << "INSERT INTO PROVIDERS VALUES(" <<
-			Project::get_current_projid() << ',' <<
-			cu.get_id() << ',' <<
-			i->get_id() << ");\n";
+		for (set <Fileid>::const_iterator i = providers.begin(); i != providers.end(); i++) {
+			db->begin_row(of, "PROVIDERS");
+			db->int_value(of, Project::get_current_projid());
+			db->int_value(of, cu.get_id());
+			db->int_value(of, i->get_id());
+			db->end_row(of);
+		}
 	if (table_is_enabled(t_inctriggers))
 		for (ITMap::const_iterator i = include_triggers.begin(); i != include_triggers.end(); i++)
 			for (include_trigger_value::const_iterator j = i->second.begin(); j != i->second.end(); j++) {
-				of << "INSERT INTO INCTRIGGERS VALUES(" <<
-				Project::get_current_projid() << ',' <<
-				cu.get_id() << ',' <<
-				i->first.second.get_id() << ',' <<
-				i->first.first.get_id() << ',' <<
-				(unsigned)(j->first) << ',' <<
-				j->second << ");\n";
+				db->begin_row(of, "INCTRIGGERS");
+				db->int_value(of, Project::get_current_projid());
+				db->int_value(of, cu.get_id());
+				db->int_value(of, i->first.second.get_id());
+				db->int_value(of, i->first.first.get_id());
+				db->int_value(of, (unsigned)(j->first));
+				db->int_value(of, j->second);
+				db->end_row(of);
 			}
 }
@@ -56,6 +56,7 @@
 #include "call.h"
 #include "md5.h"
 #include "os.h"
+#include "memstat.h"
 
 
 Filedetails::Filedetails(string n, bool r, const FileHash &h) :
@@ -66,7 +67,8 @@ Filedetails::Filedetails(string n, bool r, const FileHash &h) :
 	hash(h),
 	ipath_offset(0),
 	hand_edited(false),
-	visited(false)
+	visited(false),
+	fun_spans_valid(false)
 {
 	set_readonly(r);
 }
@@ -74,10 +76,29 @@ Filedetails::Filedetails(string n, bool r, const FileHash &h) :
 Filedetails::Filedetails() :
 	compilation_unit(false),
 	ipath_offset(0),
-	hand_edited(false)
+	hand_edited(false),
+	fun_spans_valid(false)
 {
 }
 
+void
+FunctionSpans::build(const FCallSet &fs)
+{
+	spans.clear();
+	spans.reserve(fs.size());
+	for (Call *c : fs) {
+		if (!c->is_span_valid())
+			continue;
+		Span s;
+		s.begin = c->get_begin().get_tokid();
+		s.end = c->get_end().get_tokid();
+		s.max_end = (spans.empty() || spans.back().max_end < s.end) ?
+		    s.end : spans.back().max_end;
+		s.fun = c;
+		spans.push_back(s);
+	}
+}
+
 int
 Filedetails::get_line_number(streampos p) const
 {
@@ -244,3 +265,48 @@ Filedetails::unify_identical_files(void)
 		if (i->second.size() > 1)
 			unify_file_identifiers(i->second);
 }
+
+void
+Filedetails::memory_stats(MemoryStats &s)
+{
+	size_t bytes = vector_bytes(i2d);
+	size_t nline_ends = 0, line_end_bytes = 0;
+	size_t nlines = 0, line_bytes = 0;
+	size_t nincludes = 0, include_bytes = 0;
+
+	for (const Filedetails &f : i2d) {
+		bytes += string_bytes(f.name) + string_bytes(f.contents);
+		nline_ends += f.line_ends.size();
+		line_end_bytes += vector_bytes(f.line_ends);
+		nlines += f.processed_lines.size();
+		line_bytes += vector_bytes(f.processed_lines) +
+			vector_bytes(f.proj_processed_lines);
+		for (const vector <bool> &p : f.proj_processed_lines) {
+			nlines += p.size();
+			line_bytes += vector_bytes(p);
+		}
+		nincludes += f.includes.size() + f.includers.size();
+		include_bytes += node_bytes(f.includes) + node_bytes(f.includers);
+		for (const FileIncMap::value_type &i : f.includes)
+			include_bytes += node_bytes(i.second.include_line_numbers());
+		for (const FileIncMap::value_type &i : f.includers)
+			include_bytes += node_bytes(i.second.include_line_numbers());
+	}
+	s.add("Files", i2d.size(), bytes);
+	s.add("File line ends", nline_ends, line_end_bytes);
+	s.add("File processed lines", nlines, line_bytes);
+	s.add("File include relationships", nincludes, include_bytes);
+}
+
+void
+Filedetails::freeze()
+{
+	for (Filedetails &f : i2d) {
+		f.includes.freeze();
+		for (FileIncMap::value_type &i : f.includes)
+			i.second.freeze();
+		f.includers.freeze();
+		for (FileIncMap::value_type &i : f.includers)
+			i.second.freeze();
+	}
+}
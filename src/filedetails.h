@@ -28,14 +28,17 @@
 #include <map>
 #include <set>
 #include <vector>
+#include <algorithm>
 
 using namespace std;
 
 #include "fchar.h"
 #include "fileid.h"
+#include "tokid.h"
 #include "filemetrics.h"
 #include "token.h"
 #include "ctoken.h"
+#include "freezable.h"
 
 class Pltoken;
 
@@ -49,10 +52,12 @@ typedef map <FileHash, set<Fileid> > FI_hash_to_ids;
 
 // Details we keep for each included file for a given includer
 class IncDetails {
+public:
+	typedef FreezableSet <int> line_container;
 private:
 	bool direct;		// True if directly included
 	bool required;		// True if its inclusion is required
-	set <int> lnum;		// Line numbers that include it (for direct includes)
+	line_container lnum;	// Line numbers that include it (for direct includes)
 public:
 	// Construct with r and d
 	IncDetails(bool d, bool r) : direct(d), required(r) {}
@@ -69,7 +74,8 @@ public:
 	}
 	bool is_required() const {return required; }
 	bool is_directly_included() const {return direct; }
-	const set <int>& include_line_numbers() const {return lnum; }
+	const line_container& include_line_numbers() const {return lnum; }
+	void freeze() { lnum.freeze(); }
 };
 
 class Call;
@@ -79,9 +85,48 @@ struct function_file_order {
       bool operator()(const Call *a, const Call *b) const;
 };
 
-typedef map <Fileid, IncDetails> FileIncMap;
+typedef FreezableMap <Fileid, IncDetails> FileIncMap;
 typedef set <Call *, function_file_order> FCallSet;
+
+/*
+ * An index of a file's function spans, ordered by their beginning.
+ * Each span also records the maximum end of all spans up to it,
+ * so that the functions enclosing a Tokid are found through a
+ * binary search followed by a backward scan that stops as soon
+ * as no earlier span can reach the Tokid.
+ */
+class FunctionSpans {
+public:
+	struct Span {
+		Tokid begin, end;	// The function's span
+		Tokid max_end;		// Maximum end of this and the preceding spans
+		Call *fun;
+	};
+	typedef vector <Span>::const_iterator const_iterator;
+private:
+	vector <Span> spans;
+public:
+	// Iterate over the spans in file order
+	const_iterator begin() const { return spans.begin(); }
+	const_iterator end() const { return spans.end(); }
+	// Index the functions in fs, which are ordered by their beginning
+	void build(const FCallSet &fs);
+	// Call f for each function whose span contains t
+	template <typename F>
+	void for_each_enclosing(Tokid t, F f) const {
+		auto i = upper_bound(spans.begin(), spans.end(), t,
+		    [](const Tokid &a, const Span &b) { return a < b.begin; });
+		while (i != spans.begin()) {
+			--i;
+			if (i->max_end < t)
+				break;
+			if (t <= i->end)
+				f(i->fun);
+		}
+	}
+};
 class Filedetails;
+class MemoryStats;
 typedef vector <Filedetails> FI_id_to_details;
 typedef set <Fileid> Fileidset;
 
@@ -112,6 +157,8 @@ private:
 	bool hand_edited;	// True for files that have been hand-edited
 	string contents;	// Original contents, if hand-edited
 	bool visited;                   // For calculating transitive closures
+	FunctionSpans fun_spans;	// Index of df's spans
+	bool fun_spans_valid;		// True if fun_spans reflects df
 
 	static FI_id_to_details i2d;	// From id to file details
 	static FI_hash_to_ids identical_files;// Files that are exact duplicates
@@ -146,6 +193,10 @@ public:
 
 	// Unify identifiers of files that are exact copies
 	static void unify_identical_files(void);
+	// Add the memory used by the file details to s
+	static void memory_stats(MemoryStats &s);
+	// Compact the include maps of all files
+	static void freeze();
 
 	// Clear the visited flag for all fileids
 	static void clear_all_visited();
@@ -240,7 +291,19 @@ public:
 	}
 
 	static void add_function(Fileid id, Call *f) {
-		get_instance(id).df.insert(f);
+		Filedetails &fd = get_instance(id);
+		fd.df.insert(f);
+		fd.fun_spans_valid = false;
+	}
+
+	// Return the index of the file's function spans
+	static const FunctionSpans &get_function_spans(Fileid id) {
+		Filedetails &fd = get_instance(id);
+		if (!fd.fun_spans_valid) {
+			fd.fun_spans.build(fd.df);
+			fd.fun_spans_valid = true;
+		}
+		return fd.fun_spans;
 	}
 
 	// Get /set attributes
@@ -60,6 +60,7 @@
 int Fileid::counter;		// To generate ids
 bool Fileid::filedetails_disabled;	// Disables filedetails access
 list <string> Fileid::ro_prefix;	// Read-only prefix
+vector <int> Fileid::path_ranks;	// Path order ranks
 
 #ifdef WIN32
 // Return the canonical representation of a WIN32 filename character
@@ -196,6 +197,22 @@ Fileid::files(bool sorted)
 	return (r);
 }
 
+/*
+ * The ranks are recomputed when files have been added since they
+ * were last computed, which normally happens once after processing.
+ */
+int
+Fileid::get_path_rank() const
+{
+	if (path_ranks.size() != Filedetails::get_i2d_map_size()) {
+		vector <Fileid> sorted(files(true));
+		path_ranks.assign(Filedetails::get_i2d_map_size(), 0);
+		for (vector <Fileid>::size_type i = 0; i < sorted.size(); i++)
+			path_ranks[sorted[i].id] = i + 1;
+	}
+	return path_ranks[id];
+}
+
 FileMetrics &
 Fileid::get_pre_cpp_metrics()
 {
@@ -64,6 +64,8 @@ private:
 	static bool is_readonly(string fname);
 	// Disable filedetails support
 	static bool filedetails_disabled;
+	// Dense ranks of the files in path order, indexed by id
+	static vector <int> path_ranks;
 public:
 	// Construct a new Fileid given a filename
 	Fileid(const string& fname);
@@ -95,6 +97,8 @@ public:
 	inline friend bool operator <(const class Fileid a, const class Fileid b);
 	// Return a (possibly sorted) list of all filenames used
 	static vector <Fileid> files(bool sorted);
+	// Return the file's position in the path order of all files
+	int get_path_rank() const;
 
 	/*
 	 * Normally file details are accessed through the static member
@@ -135,4 +139,11 @@ struct fname_order {
 
 typedef set <Fileid, fname_order> IFSet;
 
+// Orders Fileids like fname_order, without comparing their paths
+struct fname_rank_order {
+      bool operator()(const Fileid &a, const Fileid &b) const {
+	      return a.get_path_rank() < b.get_path_rank();
+      }
+};
+
 #endif /* FILEID_ */
@@ -89,6 +89,8 @@ FileQuery::FileQuery(FILE *of, bool icase, Attributes::size_type cp, bool e, boo
 	// Compile regular expression specs
 	if (!compile_re(of, "Filename", "fre", fre, match_fre, str_fre, (icase ? REG_ICASE : 0)))
 	    	return;
+	if (match_fre)
+		fre_candidates = file_index.candidates(str_fre);
 }
 
 // Return the URL for re-executing this query
@@ -144,8 +146,7 @@ FileQuery::eval(Fileid &f)
 	if (!add)
 		return false;
 
-	int retval = exclude_fre ? 0 : REG_NOMATCH;
-	if (match_fre && fre.exec(f.get_path()) == retval)
+	if (match_fre && re_match(fre, fre_candidates, f.get_id(), f.get_path()) == exclude_fre)
 			return false;	// RE match failed spec
 	return true;
 }
@@ -43,6 +43,7 @@ private:
 	// Match rules
 	bool match_fre;		// Filename RE
 	bool exclude_fre;	// Exclude filenames with matching RE
+	TrigramIndex<int>::Candidates fre_candidates;	// Index candidates
 	//
 	// Query arguments
 	char match_type;	// Type of boolean match
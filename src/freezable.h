@@ -0,0 +1,354 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Associative containers that can be frozen into sorted vectors
+ *
+ */
+
+#ifndef FREEZABLE_
+#define FREEZABLE_
+
+#include <set>
+#include <map>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+
+using namespace std;
+
+#include "memstat.h"
+
+// Return the key of a set element
+struct FreezableSetKey {
+	template <typename T>
+	const T &operator()(const T &v) const { return v; }
+};
+
+// Return the key of a map element
+struct FreezableMapKey {
+	template <typename P>
+	const typename P::first_type &operator()(const P &v) const { return v.first; }
+};
+
+/*
+ * An associative container offering the interface of the tree-based
+ * container Tree.  Small containers keep their elements in a sorted
+ * vector, while large ones use a Tree, which supports the efficient
+ * insertions required while processing the source code.
+ * Once the processing is over, freeze() moves the elements of a large
+ * container into a sorted vector, which takes less space and
+ * is searched by binary search.
+ * The container can still be modified after it is frozen, but
+ * an insertion into a large container moves its elements back
+ * into a Tree.  As with a vector, insertions and erasures on a
+ * container held in a vector invalidate its iterators and references.
+ */
+template <typename Tree, typename KeyOf, bool Multi>
+class Freezable {
+public:
+	typedef typename Tree::key_type key_type;
+	typedef typename Tree::value_type value_type;
+	typedef typename Tree::key_compare key_compare;
+	typedef typename Tree::size_type size_type;
+private:
+	typedef vector <value_type> Vector;
+	// Largest size of a container kept in a vector while it is modified
+	static const size_type max_small = 16;
+	Vector v;		// Elements in order, when t is null
+	unique_ptr <Tree> t;	// Elements of a large modified container
+
+	// Iterator over either of the two representations
+	template <typename VI, typename TI>
+	class basic_iterator {
+		friend class Freezable;
+		template <typename, typename> friend class basic_iterator;
+		VI vi;
+		TI ti;
+		bool in_tree;
+	public:
+		typedef bidirectional_iterator_tag iterator_category;
+		typedef typename iterator_traits<TI>::value_type value_type;
+		typedef typename iterator_traits<TI>::difference_type difference_type;
+		typedef typename iterator_traits<TI>::pointer pointer;
+		typedef typename iterator_traits<TI>::reference reference;
+
+		basic_iterator() : vi(), ti(), in_tree(false) {}
+		basic_iterator(VI i) : vi(i), ti(), in_tree(false) {}
+		basic_iterator(TI i) : vi(), ti(i), in_tree(true) {}
+		// Convert an iterator into a const_iterator
+		template <typename VI2, typename TI2, typename =
+		    typename enable_if<is_convertible<VI2, VI>::value>::type>
+		basic_iterator(const basic_iterator<VI2, TI2> &o) :
+			vi(o.vi), ti(o.ti), in_tree(o.in_tree) {}
+
+		reference operator*() const { return in_tree ? *ti : *vi; }
+		pointer operator->() const { return &**this; }
+		basic_iterator &operator++() {
+			if (in_tree)
+				++ti;
+			else
+				++vi;
+			return *this;
+		}
+		basic_iterator operator++(int) {
+			basic_iterator r(*this);
+			++*this;
+			return r;
+		}
+		basic_iterator &operator--() {
+			if (in_tree)
+				--ti;
+			else
+				--vi;
+			return *this;
+		}
+		basic_iterator operator--(int) {
+			basic_iterator r(*this);
+			--*this;
+			return r;
+		}
+		friend bool operator==(const basic_iterator &a, const basic_iterator &b) {
+			return a.in_tree ? a.ti == b.ti : a.vi == b.vi;
+		}
+		friend bool operator!=(const basic_iterator &a, const basic_iterator &b) {
+			return !(a == b);
+		}
+	};
+public:
+	typedef basic_iterator <typename Vector::iterator, typename Tree::iterator> iterator;
+	typedef basic_iterator <typename Vector::const_iterator, typename Tree::const_iterator> const_iterator;
+	typedef typename conditional<Multi, iterator, pair <iterator, bool> >::type insert_return_type;
+private:
+	// Vector position of the first element not ordered before k
+	typename Vector::iterator v_lower_bound(const key_type &k) {
+		return std::lower_bound(v.begin(), v.end(), k,
+		    [](const value_type &a, const key_type &b) { return key_compare()(KeyOf()(a), b); });
+	}
+	// Vector position of the first element ordered after k
+	typename Vector::iterator v_upper_bound(const key_type &k) {
+		return std::upper_bound(v.begin(), v.end(), k,
+		    [](const key_type &a, const value_type &b) { return key_compare()(a, KeyOf()(b)); });
+	}
+
+	/*
+	 * Insert x into the vector before i.
+	 * Map elements have a constant key and cannot be assigned,
+	 * so a vector of them is rebuilt around the new element.
+	 */
+	iterator v_insert(typename Vector::iterator i, const value_type &x) {
+		if constexpr (is_move_assignable<value_type>::value)
+			return iterator(v.insert(i, x));
+		else {
+			size_type n = i - v.begin();
+			Vector nv;
+			nv.reserve(v.size() + 1);
+			move(v.begin(), i, back_inserter(nv));
+			nv.push_back(x);
+			move(i, v.end(), back_inserter(nv));
+			v.swap(nv);
+			return iterator(v.begin() + n);
+		}
+	}
+
+	// Erase the vector's elements from b to e, returning their successor
+	iterator v_erase(typename Vector::iterator b, typename Vector::iterator e) {
+		if constexpr (is_move_assignable<value_type>::value)
+			return iterator(v.erase(b, e));
+		else {
+			size_type n = b - v.begin();
+			Vector nv;
+			nv.reserve(v.size() - (e - b));
+			move(v.begin(), b, back_inserter(nv));
+			move(e, v.end(), back_inserter(nv));
+			v.swap(nv);
+			return iterator(v.begin() + n);
+		}
+	}
+
+	// Insert x into the tree, returning its position
+	iterator t_insert(const value_type &x, true_type) {
+		return iterator(t->insert(x));
+	}
+	pair <iterator, bool> t_insert(const value_type &x, false_type) {
+		auto r = t->insert(x);
+		return make_pair(iterator(r.first), r.second);
+	}
+public:
+	Freezable() {}
+	Freezable(const Freezable &o) : v(o.v), t(o.t ? new Tree(*o.t) : nullptr) {}
+	Freezable(Freezable &&o) = default;
+	Freezable &operator=(const Freezable &o) {
+		if (this != &o) {
+			Vector(o.v).swap(v);
+			t.reset(o.t ? new Tree(*o.t) : nullptr);
+		}
+		return *this;
+	}
+	Freezable &operator=(Freezable &&o) = default;
+
+	iterator begin() { return t ? iterator(t->begin()) : iterator(v.begin()); }
+	iterator end() { return t ? iterator(t->end()) : iterator(v.end()); }
+	const_iterator begin() const { return t ? const_iterator(t->cbegin()) : const_iterator(v.cbegin()); }
+	const_iterator end() const { return t ? const_iterator(t->cend()) : const_iterator(v.cend()); }
+
+	size_type size() const { return t ? t->size() : v.size(); }
+	bool empty() const { return size() == 0; }
+
+	void clear() {
+		t.reset();
+		Vector().swap(v);
+	}
+
+	iterator lower_bound(const key_type &k) {
+		return t ? iterator(t->lower_bound(k)) : iterator(v_lower_bound(k));
+	}
+	iterator upper_bound(const key_type &k) {
+		return t ? iterator(t->upper_bound(k)) : iterator(v_upper_bound(k));
+	}
+	const_iterator lower_bound(const key_type &k) const {
+		return const_cast<Freezable *>(this)->lower_bound(k);
+	}
+	const_iterator upper_bound(const key_type &k) const {
+		return const_cast<Freezable *>(this)->upper_bound(k);
+	}
+	pair <iterator, iterator> equal_range(const key_type &k) {
+		return make_pair(lower_bound(k), upper_bound(k));
+	}
+	pair <const_iterator, const_iterator> equal_range(const key_type &k) const {
+		return make_pair(lower_bound(k), upper_bound(k));
+	}
+
+	iterator find(const key_type &k) {
+		iterator i = lower_bound(k);
+		if (i == end() || key_compare()(k, KeyOf()(*i)))
+			return end();
+		return i;
+	}
+	const_iterator find(const key_type &k) const {
+		return const_cast<Freezable *>(this)->find(k);
+	}
+	size_type count(const key_type &k) const {
+		pair <const_iterator, const_iterator> r(equal_range(k));
+		return distance(r.first, r.second);
+	}
+
+	// Insert x, after any elements with an equal key for a multi container
+	insert_return_type insert(const value_type &x) {
+		if (!t) {
+			const key_type &k = KeyOf()(x);
+			typename Vector::iterator i;
+			if constexpr (Multi)
+				i = v_upper_bound(k);
+			else {
+				i = v_lower_bound(k);
+				if (i != v.end() && !key_compare()(k, KeyOf()(*i)))
+					return make_pair(iterator(i), false);
+			}
+			if (v.size() < max_small) {
+				if constexpr (Multi)
+					return v_insert(i, x);
+				else
+					return make_pair(v_insert(i, x), true);
+			}
+			// Too large for efficient insertions; move into a tree
+			t.reset(new Tree(make_move_iterator(v.begin()), make_move_iterator(v.end())));
+			Vector().swap(v);
+		}
+		return t_insert(x, integral_constant<bool, Multi>());
+	}
+	// The position hint is only used by the tree
+	iterator insert(const_iterator hint, const value_type &x) {
+		if (t && hint.in_tree)
+			return iterator(t->insert(hint.ti, x));
+		if constexpr (Multi)
+			return insert(x);
+		else
+			return insert(x).first;
+	}
+
+	iterator erase(const_iterator i) {
+		if (t)
+			return iterator(t->erase(i.ti));
+		typename Vector::iterator b = v.begin() + (i.vi - v.cbegin());
+		return v_erase(b, b + 1);
+	}
+	size_type erase(const key_type &k) {
+		if (t)
+			return t->erase(k);
+		typename Vector::iterator b = v_lower_bound(k), e = v_upper_bound(k);
+		size_type n = e - b;
+		v_erase(b, e);
+		return n;
+	}
+
+	// Return a reference to the value mapped to k, inserting it if needed
+	template <typename T = Tree>
+	typename T::mapped_type &operator[](const key_type &k) {
+		iterator i = lower_bound(k);
+		if (i == end() || key_compare()(k, i->first))
+			i = insert(i, value_type(k, typename T::mapped_type()));
+		return i->second;
+	}
+
+	/*
+	 * Move the elements into a vector of the exact size.
+	 * They are erased from the tree as they are moved, so that the
+	 * memory required by the conversion does not exceed by much
+	 * the tree's original size.
+	 */
+	void freeze() {
+		if (!t) {
+			v.shrink_to_fit();
+			return;
+		}
+		v.reserve(t->size());
+		for (typename Tree::iterator i = t->begin(); i != t->end(); i = t->erase(i))
+			v.push_back(*i);
+		t.reset();
+	}
+
+	// Estimated heap size of the container's elements
+	size_t heap_bytes() const {
+		if (t)
+			return sizeof(Tree) + t->size() * (sizeof(value_type) + tree_node_overhead);
+		return v.capacity() * sizeof(value_type);
+	}
+};
+
+template <typename K, typename C = less<K> >
+using FreezableSet = Freezable <set <K, C>, FreezableSetKey, false>;
+
+template <typename K, typename M>
+using FreezableMap = Freezable <map <K, M>, FreezableMapKey, false>;
+
+template <typename K, typename M>
+using FreezableMultimap = Freezable <multimap <K, M>, FreezableMapKey, true>;
+
+// Estimated heap size of a freezable container's elements
+template <typename Tree, typename KeyOf, bool Multi>
+size_t
+node_bytes(const Freezable <Tree, KeyOf, Multi> &c)
+{
+	return c.heap_bytes();
+}
+
+#endif /* FREEZABLE_ */
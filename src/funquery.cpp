@@ -138,6 +138,23 @@ FunQuery::FunQuery(FILE *of, bool icase, Attributes::size_type cp, bool e, bool
 	    !compile_re(of, "Called function name", "fdre", fdre, match_fdre, str_fdre) ||
 	    !compile_re(of, "Filename", "fre", fre, match_fre, str_fre, (icase ? REG_ICASE : 0)))
 	    	return;
+	if (match_fnre)
+		fnre_candidates = name_index.candidates(str_fnre);
+	if (match_fure)
+		fure_candidates = name_index.candidates(str_fure);
+	if (match_fdre)
+		fdre_candidates = name_index.candidates(str_fdre);
+	if (match_fre)
+		fre_candidates = file_index.candidates(str_fre);
+}
+
+TrigramIndex <Call *> FunQuery::name_index;
+
+void
+FunQuery::build_index()
+{
+	for (Call::const_fmap_iterator_type i = Call::fbegin(); i != Call::fend(); i++)
+		name_index.add(i->second, i->second->get_name());
 }
 
 // Return the URL for re-executing this query
@@ -288,18 +305,16 @@ FunQuery::eval(Call *c)
 	if (ncallerop && !Query::apply(ncallerop, c->get_num_caller(), ncallers))
 		return false;
 
-	int retval = exclude_fnre ? 0 : REG_NOMATCH;
-	if (match_fnre && fnre.exec(c->get_name()) == retval)
+	if (match_fnre && re_match(fnre, fnre_candidates, c, c->get_name()) == exclude_fnre)
 		return false;
 
-	retval = exclude_fre ? 0 : REG_NOMATCH;
-	if (match_fre && fre.exec(c->get_fileid().get_path()) == retval)
+	if (match_fre && re_match(fre, fre_candidates, c->get_fileid().get_id(), c->get_fileid().get_path()) == exclude_fre)
 			return false;
 
 	Call::const_fiterator_type c2;
 	if (match_fdre) {
 		for (c2 = c->call_begin(); c2 != c->call_end(); c2++)
-			if (fdre.exec((*c2)->get_name()) == 0) {
+			if (re_match(fdre, fdre_candidates, *c2, (*c2)->get_name())) {
 				if (exclude_fdre)
 					return false;
 				else
@@ -310,7 +325,7 @@ FunQuery::eval(Call *c)
 	}
 	if (match_fure) {
 		for (c2 = c->caller_begin(); c2 != c->caller_end(); c2++)
-			if (fure.exec((*c2)->get_name()) == 0) {
+			if (re_match(fure, fure_candidates, *c2, (*c2)->get_name())) {
 				if (exclude_fure)
 					return false;
 				else
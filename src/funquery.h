@@ -56,6 +56,12 @@ private:
 	bool exclude_fdre;	// Called function name RE (down)
 	bool exclude_fure;	// Calling function name RE (up)
 	bool exclude_fre;	// Filename RE
+	// Index candidates
+	TrigramIndex<Call *>::Candidates fnre_candidates;
+	TrigramIndex<Call *>::Candidates fdre_candidates;
+	TrigramIndex<Call *>::Candidates fure_candidates;
+	TrigramIndex<int>::Candidates fre_candidates;
+	static TrigramIndex <Call *> name_index;	// Function names
 	// Query arguments
 	char match_type;	// Type of boolean match
 	bool cfun;		// True if C function
@@ -91,6 +97,8 @@ public:
 
 	// Perform a query
 	bool eval(Call *c);
+	// Build the index of function names
+	static void build_index();
 	// Return the URL for re-executing this query
 	string base_url() const;
 	// Return the query's parameters as a URL
@@ -99,6 +107,8 @@ public:
 	int get_sort_order() const { return mquery.get_sort_order(); }
 	// Return true if the query's URL can be bookmarked across CScout invocations
 	bool bookmarkable() const { return id_ec == NULL; }
+	// Return the project to which the query's matches are restricted, or 0
+	Attributes::size_type get_project_scope() const { return lazy || call || id_ec ? 0 : current_project; }
 
 	// Modern C++11 comparator type using std::function
 	using FunComparator = std::function<bool(const Call *, const Call *)>;
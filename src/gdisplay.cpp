@@ -39,6 +39,7 @@
 #include <cstdio>		// perror, rename
 #include <cstdlib>		// atoi
 #include <cerrno>		// errno
+#include <climits>		// INT_MAX
 
 #include "swill.h"
 #include "getopt.h"
@@ -71,13 +72,20 @@
 #include "compiledre.h"
 #include "html.h"
 #include "option.h"
+#include "md5.h"
+#include "pager.h"
+#include "os.h"
 
 #include "gdisplay.h"
 
 #if defined(unix) || defined(__unix__) || defined(__MACH__)
 #include <sys/types.h>		// mkdir
 #include <sys/stat.h>		// mkdir
-#include <unistd.h>		// unlink
+#include <unistd.h>		// unlink, pipe, fork
+#include <sys/wait.h>		// waitpid
+#include <poll.h>		// poll
+#include <fcntl.h>		// fcntl
+#include <csignal>		// signal
 #elif defined(WIN32)
 #include <io.h>			// mkdir
 #include <fcntl.h>		// O_BINARY
@@ -99,61 +107,221 @@ GDDot::head(const char *fname, const char *, bool empty_node) {
 	fprintf(fdot, "\tedge [%s];\n", Option::dot_edge_options->get().c_str());
 }
 
+// Rendered images, keyed by their format and their dot graph's MD5 hash
+static QueryCache <char> image_cache(32);
+
 void
 GDDotImage::head(const char *fname, const char *title, bool empty_node)
 {
-	#if defined(unix) || defined(__unix__) || defined(__MACH__)
-	dot_dir = "/tmp";
-	#elif defined(WIN32)
-	char *tmp = getenv("TEMP");
-	dot_dir = tmp ? tmp : ".";
+	#ifdef WIN32
+	fdot = tmpfile();
 	#else
-	#error "Don't know how to obtain temporary directory"
+	fdot = open_memstream(&dot_text, &dot_len);
 	#endif
-	dot_dir += "/CS-XXXXXX";
-	if (mkdtemp(&dot_dir[0]) == NULL) {
-		html_perror(fo, "Unable to create temporary directory " + dot_dir, true);
-		return;
-	}
-	dot = dot_dir + "/in.dot";
-	img = dot_dir + "/out.img";
-	fdot = fopen(dot.c_str(), "w");
 	if (fdot == NULL) {
-		html_perror(fo, "Unable to open " + dot + " for writing", true);
+		html_perror(fo, "Unable to create the dot graph buffer", true);
 		return;
 	}
 	GDDot::head(fname, title, empty_node);
 }
 
-void
-GDDotImage::tail()
+#if defined(unix) || defined(__unix__) || defined(__MACH__)
+// Pipe the graph through dot, without using temporary files
+bool
+GDDotImage::render(vector <char> &img, string &err)
 {
-	GDDot::tail();
-	fclose(fdot);
+	int in[2], out[2];
+	if (pipe(in) < 0) {
+		err = "Unable to create dot input pipe";
+		return false;
+	}
+	if (pipe(out) < 0) {
+		close(in[0]);
+		close(in[1]);
+		err = "Unable to create dot output pipe";
+		return false;
+	}
+	string fmt_arg = string("-T") + format;
+	if (DP())
+		cout << "dot " << fmt_arg << '\n';
+	pid_t pid = fork();
+	switch (pid) {
+	case -1:
+		close(in[0]);
+		close(in[1]);
+		close(out[0]);
+		close(out[1]);
+		err = "Unable to fork dot";
+		return false;
+	case 0:
+		dup2(in[0], STDIN_FILENO);
+		dup2(out[1], STDOUT_FILENO);
+		close(in[0]);
+		close(in[1]);
+		close(out[0]);
+		close(out[1]);
+		// Close the server's listening and client sockets
+		close_fds(STDERR_FILENO + 1, INT_MAX);
+		execlp("dot", "dot", fmt_arg.c_str(), (char *)NULL);
+		perror("dot");
+		_exit(127);
+	}
+	close(in[0]);
+	close(out[1]);
+	// Write only as much as the pipe can take, to avoid blocking
+	fcntl(in[1], F_SETFL, fcntl(in[1], F_GETFL) | O_NONBLOCK);
+
+	// Report a dot that exits early as an error, rather than dying
+	void (*old_handler)(int) = signal(SIGPIPE, SIG_IGN);
+	bool write_ok = true;
+	size_t written = 0;
+	if (dot_len == 0) {
+		close(in[1]);
+		in[1] = -1;
+	}
+	char buff[64 * 1024];
+	// Interleave writing the graph with reading the image
+	for (;;) {
+		struct pollfd fds[2];
+		int nfds = 0;
+		fds[nfds].fd = out[0];
+		fds[nfds++].events = POLLIN;
+		if (in[1] != -1) {
+			fds[nfds].fd = in[1];
+			fds[nfds++].events = POLLOUT;
+		}
+		if (poll(fds, nfds, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			write_ok = false;
+			break;
+		}
+		if (nfds == 2 && fds[1].revents) {
+			ssize_t n = write(in[1], dot_text + written, dot_len - written);
+			if (n < 0 && errno != EINTR && errno != EAGAIN)
+				write_ok = false;
+			if (n > 0)
+				written += n;
+			if (!write_ok || written == dot_len) {
+				close(in[1]);
+				in[1] = -1;
+			}
+		}
+		if (fds[0].revents) {
+			ssize_t n = read(out[0], buff, sizeof(buff));
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				break;
+			img.insert(img.end(), buff, buff + n);
+		}
+	}
+	if (in[1] != -1)
+		close(in[1]);
+	close(out[0]);
+	signal(SIGPIPE, old_handler);
+
+	int status;
+	while (waitpid(pid, &status, 0) < 0)
+		if (errno != EINTR) {
+			err = "Unable to obtain the dot exit status";
+			return false;
+		}
+	if (!write_ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		err = "Unable to execute dot " + fmt_arg;
+		return false;
+	}
+	return true;
+}
+#else
+// Run dot on files in a temporary directory
+bool
+GDDotImage::render(vector <char> &img, string &err)
+{
+	char *tmp = getenv("TEMP");
+	string dot_dir(tmp ? tmp : ".");
+	dot_dir += "/CS-XXXXXX";
+	if (mkdtemp(&dot_dir[0]) == NULL) {
+		err = "Unable to create temporary directory " + dot_dir;
+		return false;
+	}
+	string dot = dot_dir + "/in.dot";
+	string out = dot_dir + "/out.img";
+	FILE *fin = fopen(dot.c_str(), "wb");
+	if (fin == NULL) {
+		err = "Unable to open " + dot + " for writing";
+		return false;
+	}
+	fwrite(dot_text, 1, dot_len, fin);
+	fclose(fin);
 	/*
 	 * Changing to the tmp directory overcomes the problem of Cygwin
 	 * differences between CScout and dot file paths
 	 */
-	cmd = "cd \"" + dot_dir + "\" && dot -T" + string(format) + " in.dot -oout.img";
+	string cmd = "cd \"" + dot_dir + "\" && dot -T" + string(format) + " in.dot -oout.img";
 	if (DP())
 		cout << cmd << '\n';
-	if (system(cmd.c_str()) != 0) {
-		html_perror(fo, "Unable to execute " + cmd + ". Shell execution", true);
+	bool ok = (system(cmd.c_str()) == 0);
+	FILE *fimg = ok ? fopen(out.c_str(), "rb") : NULL;
+	if (fimg) {
+		char buff[64 * 1024];
+		size_t n;
+		while ((n = fread(buff, 1, sizeof(buff), fimg)) > 0)
+			img.insert(img.end(), buff, buff + n);
+		fclose(fimg);
+	} else
+		err = "Unable to execute " + cmd + ". Shell execution";
+	(void)unlink(dot.c_str());
+	(void)unlink(out.c_str());
+	(void)rmdir(dot_dir.c_str());
+	return fimg != NULL;
+}
+#endif
+
+void
+GDDotImage::tail()
+{
+	if (fdot == NULL)
 		return;
-	}
-	FILE *fimg = fopen(img.c_str(), "rb");
-	if (fimg == NULL) {
-		html_perror(fo, "Unable to open " + img + " for reading", true);
+	GDDot::tail();
+	#ifdef WIN32
+	// Read back the graph from the temporary file
+	dot_len = ftell(fdot);
+	dot_text = (char *)malloc(dot_len + 1);
+	rewind(fdot);
+	if (dot_text == NULL || fread(dot_text, 1, dot_len, fdot) != dot_len) {
+		fclose(fdot);
+		fdot = NULL;
+		html_perror(fo, "Unable to read the dot graph", true);
 		return;
 	}
-	int c;
+	#endif
+	fclose(fdot);
+	fdot = NULL;
+
+	MD5_CTX ctx;
+	MD5Init(&ctx);
+	MD5Update(&ctx, (unsigned char *)dot_text, dot_len);
+	MD5Final(&ctx);
+	string key(format);
+	char hex[3];
+	for (int i = 0; i < 16; i++) {
+		snprintf(hex, sizeof(hex), "%02x", ctx.digest[i]);
+		key += hex;
+	}
+
+	QueryCache<char>::ResultPtr img(image_cache.get(key));
+	if (!img) {
+		vector <char> r;
+		string err;
+		if (!render(r, err)) {
+			html_perror(fo, err, true);
+			return;
+		}
+		img = image_cache.put(key, std::move(r));
+	}
 	#ifdef WIN32
 	setmode(fileno(result), O_BINARY);
 	#endif
-	while ((c = getc(fimg)) != EOF)
-		putc(c, result);
-	fclose(fimg);
-	(void)unlink(dot.c_str());
-	(void)unlink(img.c_str());
-	(void)rmdir(dot_dir.c_str());
+	fwrite(img->data(), 1, img->size(), result);
 }
@@ -25,6 +25,8 @@
 #define GDISPLAY_
 
 #include <string>
+#include <vector>
+#include <cstdlib>
 
 using namespace std;
 
@@ -32,6 +34,7 @@ using namespace std;
 #include "html.h"
 #include "version.h"
 #include "option.h"
+#include "json.h"
 
 
 // Abstract base class, used for drawing
@@ -54,6 +57,8 @@ public:
 	virtual void edge(Call *a, Call *b) = 0;
 	virtual void edge(Fileid a, Fileid b) = 0;
 	virtual void error(const char *msg) = 0;
+	// Note that the graph was truncated
+	virtual void truncated(const char *msg) { error(msg); }
 	virtual void tail() {};
 	virtual ~GraphDisplay() {}
 };
@@ -165,17 +170,17 @@ public:
 // Generate a graph of the specified format by calling dot
 class GDDotImage: public GDDot {
 private:
-	string dot_dir;		// Directory for input and output files
-	string img;		// Absolute image file path
-	string dot;		// Absolute dot file path
-	string cmd;		// dot command
+	char *dot_text;		// Generated dot graph
+	size_t dot_len;		// and its length
 	const char *format;	// Output format
 	FILE *result;		// Resulting image
+	// Render the dot graph into img, returning false with err set on failure
+	bool render(vector <char> &img, string &err);
 public:
-	GDDotImage(FILE *f, const char *fmt) : GDDot(NULL), format(fmt), result(f) {}
+	GDDotImage(FILE *f, const char *fmt) : GDDot(NULL), dot_text(NULL), dot_len(0), format(fmt), result(f) {}
 	void head(const char *fname, const char *title, bool empty_node);
 	virtual void tail();
-	virtual ~GDDotImage() {}
+	virtual ~GDDotImage() { free(dot_text); }
 };
 
 // SVG via dot
@@ -208,6 +213,81 @@ public:
 	virtual ~GDPdf() {}
 };
 
+/*
+ * JSON output for programs.
+ * Nodes are listed before edges, which refer to them by their id;
+ * file edges lead from the including or using file.
+ */
+class GDJson: public GraphDisplay {
+	JsonWriter w;
+	enum e_section { s_none, s_nodes, s_edges } section;
+	// Start the specified array section of the graph's output
+	void enter(const char *name, e_section s) {
+		if (section == s)
+			return;
+		leave();
+		w.key(name).begin_array();
+		section = s;
+	}
+	void leave() {
+		if (section != s_none)
+			w.end_array();
+		section = s_none;
+	}
+public:
+	GDJson(FILE *f) : GraphDisplay(f), w(f), section(s_none) {}
+	virtual void head(const char *, const char *title, bool) {
+		w.begin_object().member("title", title);
+	}
+	virtual void node(Call *p) {
+		// All graphs output their nodes first
+		if (section == s_edges)
+			return;
+		enter("nodes", s_nodes);
+		w.begin_object()
+		    .member("id", (const void *)p)
+		    .member("name", p->get_name())
+		    .member("label", function_label(p, false))
+		    .end_object();
+	}
+	virtual void node(Fileid f) {
+		if (section == s_edges)
+			return;
+		enter("nodes", s_nodes);
+		w.begin_object()
+		    .member("id", f.get_id())
+		    .member("path", f.get_path())
+		    .end_object();
+	}
+	virtual void edge(Call *a, Call *b) {
+		enter("edges", s_edges);
+		w.begin_object()
+		    .member("from", (const void *)a)
+		    .member("to", (const void *)b)
+		    .end_object();
+	}
+	virtual void edge(Fileid a, Fileid b) {
+		enter("edges", s_edges);
+		w.begin_object()
+		    .member("from", b.get_id())
+		    .member("to", a.get_id())
+		    .end_object();
+	}
+	virtual void error(const char *msg) {
+		leave();
+		w.member("error", msg);
+	}
+	virtual void truncated(const char *msg) {
+		leave();
+		w.member("truncated", msg);
+	}
+	virtual void tail() {
+		leave();
+		w.end_object();
+	}
+	virtual ~GDJson() {}
+};
+
 #endif // GDISPLAY_
 
 #ifndef GDARGSKEYS_
@@ -0,0 +1,255 @@
+#!/usr/bin/env perl
+#
+# (C) Copyright 2026 Diomidis Spinellis
+#
+# This file is part of CScout.
+#
+# CScout is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# CScout is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Generate a synthetic C workspace for benchmarking CScout
+#
+# The workspace consists of compilation units (CUs) that include
+# a number of shared headers.  Each header declares global functions,
+# which are defined in some CU and called from the CUs including it,
+# and a chain of nested function-like macros, which the CUs expand.
+# Local identifier names are drawn from a pool, whose size determines
+# how often the same name is reused across scopes and files.
+# Each CU also defines variables and their accessor functions through
+# token-pasted names.  The CUs are processed in one or more projects.
+# The generated workspace file is named bench.cs.
+#
+
+use Getopt::Std;
+
+use strict;
+use warnings;
+
+our ($opt_d, $opt_f, $opt_H, $opt_h, $opt_i, $opt_m, $opt_P, $opt_p,
+	$opt_r, $opt_s, $opt_t, $opt_u);
+
+if (!getopts('d:f:H:h:i:m:P:p:r:s:t:u:') || $#ARGV != 0) {
+	print STDERR "usage: $0 [-d depth] [-f functions] [-H headers] [-h fan-in]\n" .
+	"\t[-i pool] [-m globals] [-P projects] [-p projects-per-cu]\n" .
+	"\t[-r references] [-s statements] [-t pasted] [-u units] directory\n" .
+	"\t-d depth\tMacro nesting depth (default 4)\n" .
+	"\t-f functions\tStatic functions per CU (default 10)\n" .
+	"\t-H headers\tNumber of shared headers (default 20)\n" .
+	"\t-h fan-in\tHeaders included by each CU (default 5)\n" .
+	"\t-i pool\t\tSize of the local identifier name pool (default 50)\n" .
+	"\t-m globals\tGlobal functions declared in each header (default 10)\n" .
+	"\t-P projects\tNumber of projects (default 4)\n" .
+	"\t-p projects-per-cu\tProjects processing each CU (default 1)\n" .
+	"\t-r references\tGlobal function calls per function (default 3)\n" .
+	"\t-s statements\tStatements per function (default 10)\n" .
+	"\t-t pasted\tToken-pasted accessors per CU (default 5)\n" .
+	"\t-u units\tNumber of CUs (default 100)\n";
+	exit(1);
+}
+
+my $depth = $opt_d // 4;
+my $nfun = $opt_f // 10;
+my $nheader = $opt_H // 20;
+my $fanin = $opt_h // 5;
+my $pool = $opt_i // 50;
+my $nglobal = $opt_m // 10;
+my $nproject = $opt_P // 4;
+my $cuproject = $opt_p // 1;
+my $nref = $opt_r // 3;
+my $nstmt = $opt_s // 10;
+my $npasted = $opt_t // 5;
+my $nunit = $opt_u // 100;
+my $dir = $ARGV[0];
+
+die "$0: at least one CU, header, and project are required\n"
+	if ($nunit < 1 || $nheader < 1 || $nproject < 1 || $pool < 1);
+$fanin = $nheader if ($fanin > $nheader);
+$cuproject = $nproject if ($cuproject > $nproject);
+$depth = 1 if ($depth < 1);
+$nstmt = 1 if ($nstmt < 1);
+
+mkdir($dir);
+mkdir("$dir/include");
+-d "$dir/include" || die "$0: unable to create $dir/include: $!\n";
+
+# Deterministic pseudo-random numbers, so that runs can be compared
+my $seed = 1;
+sub
+rnd
+{
+	my ($n) = @_;
+	$seed = ($seed * 1103515245 + 12345) % 2147483648;
+	return int($seed / 65536) % $n;
+}
+
+sub
+create
+{
+	my ($name) = @_;
+	my $fh;
+	open($fh, '>', "$dir/$name") || die "$0: unable to open $dir/$name: $!\n";
+	return $fh;
+}
+
+# Headers included by CU $u
+sub
+unit_headers
+{
+	my ($u) = @_;
+	my %seen;
+	my @h;
+	for (my $k = 0; @h < $fanin && $k < $nheader; $k++) {
+		my $h = ($u * 7 + $k * 3 + $k * $k) % $nheader;
+		push(@h, $h) unless ($seen{$h}++);
+	}
+	# The probe sequence can cycle through fewer than $fanin headers
+	for (my $h = $u * 7 % $nheader; @h < $fanin; $h = ($h + 1) % $nheader) {
+		push(@h, $h) unless ($seen{$h}++);
+	}
+	return @h;
+}
+
+# The CU defining global function $g of header $h
+sub
+global_owner
+{
+	my ($h, $g) = @_;
+	return ($h * $nglobal + $g) % $nunit;
+}
+
+my $fh = create('include/common.h');
+print $fh qq{#ifndef COMMON_H
+#define COMMON_H
+
+#define PASTE(a, b) a ## b
+#define ACCESSOR(type, name) \\
+	static type name; \\
+	type PASTE(get_, name)(void) { return name; } \\
+	void PASTE(set_, name)(type v) { name = v; }
+
+typedef struct point {
+	int x, y;
+} point_t;
+
+#endif
+};
+close($fh);
+
+for (my $h = 0; $h < $nheader; $h++) {
+	$fh = create("include/h$h.h");
+	print $fh "#ifndef H${h}_H\n#define H${h}_H\n\n";
+	print $fh "struct s$h {\n\tint a;\n\tpoint_t p;\n};\n\n";
+	for (my $g = 0; $g < $nglobal; $g++) {
+		print $fh "int g${h}_$g(int x);\n";
+	}
+	print $fh "\n#define M${h}_0(x) ((x) + $h)\n";
+	for (my $d = 1; $d < $depth; $d++) {
+		my $p = $d - 1;
+		print $fh "#define M${h}_$d(x) M${h}_$p((x) * 2 + $d)\n";
+	}
+	print $fh "\n#endif\n";
+	close($fh);
+}
+
+# Return a local identifier name from the pool
+sub
+local_name
+{
+	return 'v' . rnd($pool);
+}
+
+# Output the body of a function using the specified headers
+sub
+function_body
+{
+	my ($fh, $u, $headers) = @_;
+	my %declared;
+	my @names;
+	for (my $s = 0; $s < $nstmt; $s++) {
+		my $v = local_name();
+		push(@names, $v);
+		next if ($declared{$v}++);
+		print $fh "\tint $v = x;\n";
+	}
+	for (my $s = 0; $s < $nstmt; $s++) {
+		my $v = $names[rnd(scalar(@names))];
+		my $w = $names[rnd(scalar(@names))];
+		$w = 'x' if ($w eq $v);
+		my $h = $headers->[rnd(scalar(@$headers))];
+		my $d = $depth - 1;
+		if ($s % 3 == 0) {
+			print $fh "\t$v = M${h}_$d($w);\n";
+		} elsif ($s % 3 == 1) {
+			print $fh "\tif ($v > $w)\n\t\t$v -= $w;\n";
+		} else {
+			print $fh "\t$v += get_u${u}_" . rnd($npasted) . "();\n"
+				if ($npasted);
+		}
+	}
+	for (my $r = 0; $r < $nref; $r++) {
+		my $h = $headers->[rnd(scalar(@$headers))];
+		my $g = rnd($nglobal);
+		next unless ($nglobal);
+		print $fh "\tx += g${h}_$g($names[rnd(scalar(@names))]);\n";
+	}
+	print $fh "\treturn x";
+	print $fh " + $_" for (sort keys %declared);
+	print $fh ";\n";
+}
+
+for (my $u = 0; $u < $nunit; $u++) {
+	my @headers = unit_headers($u);
+	$fh = create("u$u.c");
+	print $fh "#include \"common.h\"\n";
+	print $fh "#include \"h$_.h\"\n" for (@headers);
+	print $fh "\n";
+	for (my $t = 0; $t < $npasted; $t++) {
+		print $fh "ACCESSOR(int, u${u}_$t)\n";
+	}
+	print $fh "\n";
+	for (my $f = 0; $f < $nfun; $f++) {
+		print $fh "static int\nf$f(int x)\n{\n";
+		function_body($fh, $u, \@headers);
+		print $fh "}\n\n";
+	}
+	# Global functions owned by this CU
+	for (my $h = 0; $h < $nheader; $h++) {
+		for (my $g = 0; $g < $nglobal; $g++) {
+			next unless (global_owner($h, $g) == $u);
+			print $fh "#include \"h$h.h\"\n\n";
+			print $fh "int\ng${h}_$g(int x)\n{\n";
+			print $fh "\tstruct s$h s;\n\n\ts.a = x;\n";
+			print $fh "\treturn s.a";
+			print $fh " + f" . rnd($nfun) . "(x)" if ($nfun);
+			print $fh ";\n}\n\n";
+		}
+	}
+	close($fh);
+}
+
+$fh = create('bench.cs');
+print $fh "// Synthetic benchmark workspace\n";
+for (my $p = 0; $p < $nproject; $p++) {
+	print $fh "#pragma project \"p$p\"\n#pragma block_enter\n";
+	for (my $u = 0; $u < $nunit; $u++) {
+		next unless (($p - $u % $nproject + $nproject) % $nproject < $cuproject);
+		print $fh "#pragma block_enter\n";
+		print $fh "#pragma clear_defines\n";
+		print $fh "#pragma clear_include\n";
+		print $fh "#pragma includepath \"include\"\n";
+		print $fh "#pragma process \"u$u.c\"\n";
+		print $fh "#pragma block_exit\n";
+	}
+	print $fh "#pragma block_exit\n";
+}
+close($fh);
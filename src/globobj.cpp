@@ -56,6 +56,7 @@
 #include "eclass.h"
 #include "sql.h"
 #include "globobj.h"
+#include "memstat.h"
 
 // All global objects
 GlobObj::glob_map GlobObj::all;
@@ -72,8 +73,8 @@ void
 GlobObj::set_file_dependencies()
 {
 	for (glob_map::iterator i = all.begin(); i != all.end(); i++)
-		for (set <Fileid>::iterator def = i->second->defined.begin(); def != i->second->defined.end(); def++)
-			for (set <Fileid>::iterator ref = i->second->used.begin(); ref != i->second->used.end(); ref++)
+		for (file_container::const_iterator def = i->second->defined.begin(); def != i->second->defined.end(); def++)
+			for (file_container::const_iterator ref = i->second->used.begin(); ref != i->second->used.end(); ref++)
 				if (*ref != *def) {
 					if (DP())
 						cout << i->second->get_name() << ": " << ref->get_fname() << " uses " << def->get_fname() << endl;
@@ -109,3 +110,23 @@ GlobObj::GlobObj(const Token &t, Type typ, const string &s) :
 		cout << "Construct new globobj for " << s << endl;
 	all.insert(glob_map::value_type(t.get_parts_begin()->get_tokid(), this));
 }
+
+void
+GlobObj::memory_stats(MemoryStats &s)
+{
+	size_t bytes = node_bytes(all);
+	for (const glob_map::value_type &g : all)
+		bytes += sizeof(GlobObj) + string_bytes(g.second->name) +
+			node_bytes(g.second->defined) + node_bytes(g.second->used);
+	s.add("Global objects", all.size(), bytes);
+}
+
+void
+GlobObj::freeze()
+{
+	all.freeze();
+	for (const glob_map::value_type &g : all) {
+		g.second->defined.freeze();
+		g.second->used.freeze();
+	}
+}
@@ -34,12 +34,16 @@ using namespace std;
 #include "token.h"
 #include "type.h"
 #include "tokid.h"
+#include "freezable.h"
+
+class MemoryStats;
 
 class GlobObj {
 private:
 	string name;
-	set <Fileid> defined;	// Files where this is defined
-	set <Fileid> used;	// Files where this is used
+	typedef FreezableSet <Fileid> file_container;
+	file_container defined;	// Files where this is defined
+	file_container used;	// Files where this is used
 
 	/*
 	 * A token (almost) uniquely identifying the call entity.
@@ -53,7 +57,7 @@ private:
 	Type type;			// Object's type
 
 	// See the comment for fun_map on why this must be a multimap
-	typedef multimap <Tokid, GlobObj *> glob_map;
+	typedef FreezableMultimap <Tokid, GlobObj *> glob_map;
 	static glob_map all;	// All global objects
 public:
 	// ctor; never call it if the call for t already exists
@@ -76,6 +80,10 @@ public:
 
 	// Dump the data in SQL format
 	static void dumpSql(Sql *db, ostream &of);
+	// Add the memory used by the global objects to s
+	static void memory_stats(MemoryStats &s);
+	// Compact the global objects and their files
+	static void freeze();
 };
 
 #endif // GLOBOBJ_
@@ -39,6 +39,11 @@
 #include <cstdio>		// perror, rename
 #include <cstdlib>		// atoi
 #include <cerrno>		// errno
+#include <cstring>		// strstr
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "swill.h"
 #include "getopt.h"
@@ -201,6 +206,49 @@ html_tail(FILE *of)
 	fprintf(of, "</div></body></html>\n");
 }
 
+// Return true if the client accepts gzip-compressed responses
+bool
+html_accepts_gzip()
+{
+#ifdef HAVE_ZLIB
+	const char *accept = swill_getheader("Accept-Encoding");
+	if (!accept)
+		accept = swill_getheader("accept-encoding");
+	return accept && strstr(accept, "gzip");
+#else
+	return false;
+#endif
+}
+
+/*
+ * Output to of the specified page compressed with gzip,
+ * setting the corresponding response header.
+ * The page is output unmodified if it cannot be compressed.
+ */
+void
+html_gzip(FILE *of, const char *page, size_t len)
+{
+#ifdef HAVE_ZLIB
+	z_stream zs = {};
+	if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+	    Z_DEFAULT_STRATEGY) == Z_OK) {
+		vector <Bytef> out(deflateBound(&zs, len));
+		zs.next_in = (Bytef *)page;
+		zs.avail_in = len;
+		zs.next_out = out.data();
+		zs.avail_out = out.size();
+		int ret = deflate(&zs, Z_FINISH);
+		deflateEnd(&zs);
+		if (ret == Z_STREAM_END) {
+			swill_setheader("Content-Encoding", "gzip");
+			fwrite(out.data(), 1, zs.total_out, of);
+			return;
+		}
+	}
+#endif
+	fwrite(page, 1, len, of);
+}
+
 // Return a function's label, based on the user's preferences
 string
 file_label(Fileid f, bool hyperlink)
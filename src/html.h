@@ -40,6 +40,8 @@ void html_head(FILE *of, const string fname, const string title, const char *hea
 void html_tail(FILE *of);
 void html_perror(FILE *of, const string &user_msg, bool svg = false);
 void html_error(FILE *of, const string &user_msg);
+bool html_accepts_gzip();
+void html_gzip(FILE *of, const char *page, size_t len);
 
 string function_label(Call *f, bool hyperlink);
 string file_label(Fileid f, bool hyperlink);
@@ -70,6 +70,7 @@
 #include "option.h"
 #include "query.h"
 #include "idquery.h"
+#include "memstat.h"
 
 IdProp Identifier::ids;
 
@@ -112,6 +113,10 @@ IdQuery::IdQuery(FILE *of, bool icase, Attributes::size_type cp, bool e, bool r)
 		return;
 	if (!compile_re(of, "Filename", "fre", fre, match_fre, str_fre, (icase ? REG_ICASE : 0)))
 		return;
+	if (match_ire)
+		ire_candidates = name_index.candidates(str_ire);
+	if (match_fre)
+		fre_candidates = file_index.candidates(str_fre);
 
 	// Store match specifications in a vector
 	for (int i = attr_begin; i < attr_end; i++) {
@@ -124,6 +129,15 @@ IdQuery::IdQuery(FILE *of, bool icase, Attributes::size_type cp, bool e, bool r)
 	}
 }
 
+TrigramIndex <Eclass *> IdQuery::name_index;
+
+void
+IdQuery::build_index()
+{
+	for (const IdPropElem &i : Identifier::ids)
+		name_index.add(i.first, i.second.get_id());
+}
+
 // Report the string query specification usage
 void
 IdQuery::usage(void)
@@ -237,8 +251,7 @@ IdQuery::eval(const IdPropElem &i)
 		return (i.first == ec);
 	if (current_project && !i.first->get_attribute(current_project))
 		return false;
-	int retval = exclude_ire ? 0 : REG_NOMATCH;
-	if (match_ire && ire.exec(i.second.get_id()) == retval)
+	if (match_ire && re_match(ire, ire_candidates, i.first, i.second.get_id()) == exclude_ire)
 		return false;
 	bool add = false;
 	switch (match_type) {
@@ -291,10 +304,10 @@ IdQuery::eval(const IdPropElem &i)
 		return false;
 	if (match_fre) {
 		// Before we add it check if its filename matches the RE
-		IFSet f = i.first->sorted_files();
-		IFSet::iterator j;
+		const vector <Fileid> &f = i.first->sorted_files();
+		vector <Fileid>::const_iterator j;
 		for (j = f.begin(); j != f.end(); j++)
-			if (fre.exec((*j).get_path()) == 0) {
+			if (re_match(fre, fre_candidates, j->get_id(), j->get_path())) {
 				if (DP())
 					cout << "Identifier " << i.second.get_id() <<
 					    " occurs in file " << j->get_path() <<
@@ -309,3 +322,12 @@ IdQuery::eval(const IdPropElem &i)
 	}
 	return true;
 }
+
+void
+Identifier::memory_stats(MemoryStats &s)
+{
+	size_t bytes = node_bytes(ids);
+	for (const IdPropElem &i : ids)
+		bytes += string_bytes(i.second.id) + string_bytes(i.second.newid);
+	s.add("Identifiers", ids.size(), bytes);
+}
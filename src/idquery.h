@@ -32,10 +32,12 @@ using namespace std;
 #include "query.h"
 #include "eclass.h"
 #include "filedetails.h"
+#include "freezable.h"
 
 class Identifier;
+class MemoryStats;
 
-typedef map <Eclass *, Identifier> IdProp;
+typedef FreezableMap <Eclass *, Identifier> IdProp;
 
 // Our identifiers to store as a map
 class Identifier {
@@ -47,6 +49,8 @@ class Identifier {
 public:
 	// Additional identifier properties required for refactoring
 	static IdProp ids;
+	// Add the memory used by the identifiers to s
+	static void memory_stats(MemoryStats &s);
 
 	Identifier(Eclass *e, const string &s) : id(s), replaced(false), active(true) {
 		/*
@@ -56,7 +60,8 @@ public:
 		 * For this second condition it is enough to check the identical files of one element
 		 */
 		Tokid amember(*(e->get_members().begin()));
-		xfile = e->sorted_files().size() > Filedetails::get_identical_files(amember.get_fileid()).size();
+		xfile = e->crosses_files() &&
+		    (size_t)e->get_nfiles() > Filedetails::get_identical_files(amember.get_fileid()).size();
 	}
 	Identifier() : xfile(false), replaced(false), active(false) {}
 	string get_id() const { return id; }
@@ -87,6 +92,10 @@ private:
 	bool match_fre, match_ire;
 	bool exclude_ire;	// Exclude matched identifiers
 	bool exclude_fre;	// Exclude matched files
+	// Index candidates for the REs
+	TrigramIndex<Eclass *>::Candidates ire_candidates;
+	TrigramIndex<int>::Candidates fre_candidates;
+	static TrigramIndex <Eclass *> name_index;	// Identifier names
 	// Attribute match specs
 	vector <bool> match;
 	// Other query arguments
@@ -116,8 +125,12 @@ public:
 	// Return the query's parameters as a URL
 	string param_url() const;
 	static void usage();	// Report string constructor usage information
+	// Build the index of identifier names
+	static void build_index();
 	// Return true if the query's URL can be bookmarked across CScout invocations
 	bool bookmarkable() const { return ec == NULL; }
+	// Return the project to which the query's matches are restricted, or 0
+	Attributes::size_type get_project_scope() const { return lazy || ec ? 0 : current_project; }
 };
 
 /*
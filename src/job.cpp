@@ -0,0 +1,421 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Evaluation of long-running pages as background jobs
+ *
+ */
+
+#include <map>
+#include <string>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <climits>
+#include <algorithm>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+#include "swill.h"
+#include "html.h"
+#include "job.h"
+#include "os.h"
+
+map <int, Job> Job::jobs;
+int Job::next_id = 1;
+int Job::progress_out = -1;
+pid_t Job::server_pid;
+
+const char *
+Job::get_state_name() const
+{
+	switch (state) {
+	case js_running: return "running";
+	case js_done: return "done";
+	case js_failed: return "failed";
+	case js_cancelled: return "cancelled";
+	}
+	return "unknown";
+}
+
+#ifdef WIN32
+
+int
+Job::start(const string &, SwillHandler, void *)
+{
+	return -1;
+}
+
+void Job::update() {}
+void Job::update_all() {}
+void Job::close_progress() {}
+void Job::cancel() {}
+void Job::remove_all() {}
+void Job::write_result(FILE *) const {}
+
+bool
+Job::report_progress(int)
+{
+	return false;
+}
+
+#else
+
+int
+Job::start(const string &title, SwillHandler h, void *data)
+{
+	// Reap the jobs that finished since the last request
+	update_all();
+
+	char path[] = "/tmp/cscout-job-XXXXXX";
+	int fd = mkstemp(path);
+	if (fd == -1) {
+		perror("mkstemp");
+		return -1;
+	}
+	/*
+	 * The job writes and the server reads the output through the
+	 * open descriptor, so the file is removed when it gets closed,
+	 * even if the server does not exit normally.
+	 */
+	unlink(path);
+	int pfd[2];
+	if (pipe(pfd) == -1) {
+		perror("pipe");
+		close(fd);
+		return -1;
+	}
+	// Neither end shall block the job or the server
+	fcntl(pfd[0], F_SETFL, O_NONBLOCK);
+	fcntl(pfd[1], F_SETFL, O_NONBLOCK);
+
+	if (server_pid == 0) {
+		atexit(remove_all);
+		server_pid = getpid();
+	}
+
+	pid_t pid = fork();
+	switch (pid) {
+	case -1:
+		perror("fork");
+		close(fd);
+		close(pfd[0]);
+		close(pfd[1]);
+		return -1;
+	case 0:
+		/*
+		 * Close the inherited descriptors, such as the listening
+		 * and the client sockets, so that the client sees its
+		 * response completed when the server closes the connection.
+		 */
+		{
+			int lo = min(fd, pfd[1]), hi = max(fd, pfd[1]);
+			close_fds(3, lo - 1);
+			close_fds(lo + 1, hi - 1);
+			close_fds(hi + 1, INT_MAX);
+		}
+		progress_out = pfd[1];
+		FILE *of = fdopen(fd, "w");
+		int status = 1;
+		if (of) {
+			h(of, data);
+			status = fclose(of) == 0 ? 0 : 1;
+		}
+		_exit(status);
+	}
+	close(pfd[1]);
+
+	Job &j = jobs[next_id];
+	j.id = next_id++;
+	j.title = title;
+	j.result_fd = fd;
+	j.pid = pid;
+	j.progress_fd = pfd[0];
+	j.percent = 0;
+	j.state = js_running;
+	j.started = time(NULL);
+	return j.id;
+}
+
+bool
+Job::report_progress(int percent)
+{
+	if (progress_out == -1)
+		return false;
+	unsigned char c = (unsigned char)percent;
+	// Progress is advisory; drop it if the pipe is full
+	if (write(progress_out, &c, 1) == -1 && errno != EAGAIN)
+		perror("write");
+	return true;
+}
+
+void
+Job::close_progress()
+{
+	if (progress_fd != -1) {
+		close(progress_fd);
+		progress_fd = -1;
+	}
+}
+
+void
+Job::update()
+{
+	if (state != js_running)
+		return;
+	unsigned char buff[128];
+	ssize_t n;
+	while ((n = read(progress_fd, buff, sizeof(buff))) > 0)
+		percent = buff[n - 1];
+
+	int status;
+	if (waitpid(pid, &status, WNOHANG) != pid)
+		return;
+	close_progress();
+	if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+		state = js_done;
+		percent = 100;
+	} else
+		state = js_failed;
+}
+
+void
+Job::update_all()
+{
+	for (auto &j : jobs)
+		j.second.update();
+}
+
+void
+Job::cancel()
+{
+	update();
+	if (state != js_running)
+		return;
+	kill(pid, SIGTERM);
+	waitpid(pid, NULL, 0);
+	close_progress();
+	state = js_cancelled;
+}
+
+void
+Job::remove_all()
+{
+	// Registered with atexit, which a job also inherits
+	if (getpid() != server_pid)
+		return;
+	for (auto &j : jobs) {
+		j.second.cancel();
+		close(j.second.result_fd);
+	}
+	jobs.clear();
+}
+
+void
+Job::write_result(FILE *of) const
+{
+	// Read from the start, without moving the shared file offset
+	char buff[BUFSIZ];
+	ssize_t n;
+	off_t offset = 0;
+	while ((n = pread(result_fd, buff, sizeof(buff), offset)) > 0) {
+		fwrite(buff, 1, n, of);
+		offset += n;
+	}
+	if (n == -1)
+		html_perror(of, "Unable to read the output of job " + to_string(id));
+}
+
+#endif
+
+Job *
+Job::find(int id)
+{
+	update_all();
+	auto i = jobs.find(id);
+	if (i == jobs.end())
+		return NULL;
+	return &i->second;
+}
+
+void
+Job::remove(int id)
+{
+	Job *j = find(id);
+	if (!j)
+		return;
+	j->cancel();
+	close(j->result_fd);
+	jobs.erase(id);
+}
+
+// A page registered for background evaluation
+struct JobPage {
+	string title;		// Description of the job
+	SwillHandler handler;	// Function evaluating the page
+	void *data;		// Its data
+};
+
+/*
+ * Evaluate the page p.  If the bg parameter is set, start a job
+ * for it and display the job's status page.
+ */
+static int
+job_run_page(FILE *of, void *p)
+{
+	const JobPage *jp = (const JobPage *)p;
+
+	if (!swill_getvar("bg") || Job::is_job())
+		return jp->handler(of, jp->data);
+
+	string title(jp->title);
+	char *name = swill_getvar("n");
+	if (name && *name)
+		title += string(": ") + name;
+	int id = Job::start(title, jp->handler, jp->data);
+	if (id == -1)
+		// Unable to start a job; evaluate it here
+		return jp->handler(of, jp->data);
+	html_head(of, "job", "Job Started");
+	fprintf(of, "<p>The evaluation of <em>%s</em> is running "
+	    "in the background as "
+	    "<a href=\"job.html?id=%d\">job %d</a>.</p>\n"
+	    "<p>Visit the <a href=\"jobs.html\">background jobs</a> page "
+	    "to follow its progress.</p>\n",
+	    html(title).c_str(), id, id);
+	html_tail(of);
+	return 0;
+}
+
+void
+job_handle(const char *url, const char *title, SwillHandler h, void *data)
+{
+	// The registration lasts for the program's lifetime
+	JobPage *jp = new JobPage{title, h, data};
+	swill_handle(url, job_run_page, jp);
+}
+
+/*
+ * Display a finished job's output; otherwise its status.
+ * With cancel or remove set, act on the job and show the job list.
+ */
+int
+job_page(FILE *of, void *p)
+{
+	int id;
+	if (!swill_getargs("i(id)", &id)) {
+		fprintf(of, "Missing value");
+		return 0;
+	}
+	if (swill_getvar("remove")) {
+		Job::remove(id);
+		return jobs_page(of, p);
+	}
+	Job *j = Job::find(id);
+	if (!j) {
+		html_head(of, "job", "Unknown Job");
+		fprintf(of, "<p>Job %d does not exist.</p>\n", id);
+		html_tail(of);
+		return 0;
+	}
+	if (swill_getvar("cancel")) {
+		j->cancel();
+		return jobs_page(of, p);
+	}
+	if (j->get_state() == Job::js_done) {
+		j->write_result(of);
+		return 0;
+	}
+	html_head(of, "job", "Job " + to_string(id) + ": " + html(j->get_title()));
+	fprintf(of, "<p>State: %s", j->get_state_name());
+	if (j->get_state() == Job::js_running) {
+		fprintf(of, ", %d%% complete, running for %lds</p>\n",
+		    j->get_percent(), (long)(time(NULL) - j->get_started()));
+		// Poll for completion
+		fprintf(of, "<meta http-equiv=\"refresh\" content=\"5\">\n"
+		    "<p><a href=\"job.html?id=%d\">Refresh</a> &mdash; "
+		    "<a href=\"job.html?id=%d&cancel=1\">Cancel</a></p>\n",
+		    id, id);
+	} else
+		fputs("</p>\n", of);
+	fputs("<p><a href=\"jobs.html\">All background jobs</a></p>\n", of);
+	html_tail(of);
+	return 0;
+}
+
+// Output "state percent", for polling by scripts
+int
+job_status_page(FILE *of, void *)
+{
+	int id;
+	if (!swill_getargs("i(id)", &id)) {
+		fprintf(of, "Missing value");
+		return 0;
+	}
+	Job *j = Job::find(id);
+	if (!j)
+		fputs("unknown 0\n", of);
+	else
+		fprintf(of, "%s %d\n", j->get_state_name(), j->get_percent());
+	return 0;
+}
+
+int
+jobs_page(FILE *of, void *)
+{
+	html_head(of, "jobs", "Background Jobs");
+	bool empty = true;
+	Job::for_each([&](const Job &j) {
+		if (empty) {
+			fputs("<table class='metrics'>\n<tr>"
+			    "<th>Job</th>"
+			    "<th>Description</th>"
+			    "<th>State</th>"
+			    "<th>Progress</th>"
+			    "<th>Actions</th>"
+			    "</tr>\n", of);
+			empty = false;
+		}
+		int id = j.get_id();
+		fprintf(of, "<tr><td><a href=\"job.html?id=%d\">%d</a></td>"
+		    "<td>%s</td><td>%s</td><td align='right'>%d%%</td><td>",
+		    id, id, html(j.get_title()).c_str(), j.get_state_name(),
+		    j.get_percent());
+		if (j.get_state() == Job::js_running)
+			fprintf(of, "<a href=\"job.html?id=%d&cancel=1\">cancel</a>", id);
+		else
+			fprintf(of, "<a href=\"job.html?id=%d&remove=1\">remove</a>", id);
+		fputs("</td></tr>\n", of);
+	});
+	if (empty)
+		fputs("<p>No background jobs have been submitted.</p>\n", of);
+	else
+		fputs("</table>\n", of);
+	fputs("<p>Queries are run as background jobs "
+	    "by checking the corresponding option on their form.</p>\n", of);
+	html_tail(of);
+	return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Evaluation of long-running pages as background jobs
+ *
+ */
+
+#ifndef JOB_
+#define JOB_
+
+#include <map>
+#include <string>
+#include <cstdio>
+#include <ctime>
+
+#include <sys/types.h>
+
+#include "swill.h"
+
+using namespace std;
+
+/*
+ * A page evaluated in the background.
+ * The page is evaluated in a forked child process, which sees a
+ * snapshot of the workspace, writes the page into a temporary file,
+ * and reports its progress to the server through a pipe.
+ * Meanwhile the server continues to serve other requests.
+ */
+class Job {
+public:
+	enum e_state {
+		js_running,
+		js_done,
+		js_failed,
+		js_cancelled,
+	};
+private:
+	int id;
+	string title;		// Description shown in the job list
+	int result_fd;		// Removed file holding the page's output
+	pid_t pid;		// Process evaluating the page
+	int progress_fd;	// Read end of the progress pipe
+	int percent;		// Last progress reported
+	e_state state;
+	time_t started;
+
+	static map <int, Job> jobs;
+	static int next_id;
+	static int progress_out;	// In the job: write end of the progress pipe
+	static pid_t server_pid;	// Process that started the jobs
+
+	// Collect the job's progress and termination status
+	void update();
+	void close_progress();
+	/*
+	 * Update all jobs, reaping the finished ones.
+	 * Called on every job-related request.
+	 */
+	static void update_all();
+	// Terminate the running jobs and remove their output
+	static void remove_all();
+public:
+	/*
+	 * Start evaluating the page handler h with the specified data
+	 * in the background.  Return the job's id, or -1 if the
+	 * job could not be started.
+	 */
+	static int start(const string &title, SwillHandler h, void *data);
+	// Return the job with the specified id, or NULL
+	static Job *find(int id);
+	// Cancel the job, if it is still running
+	void cancel();
+	// Remove the job and its output
+	static void remove(int id);
+
+	// Return true when executing as a job
+	static bool is_job() { return progress_out != -1; }
+	// Report a loop's progress, returning false if not executing as a job
+	static bool report_progress(int percent);
+
+	int get_id() const { return id; }
+	const string &get_title() const { return title; }
+	e_state get_state() const { return state; }
+	int get_percent() const { return percent; }
+	time_t get_started() const { return started; }
+	const char *get_state_name() const;
+	// Copy the job's output to of
+	void write_result(FILE *of) const;
+
+	// Update and visit all jobs
+	template <typename F>
+	static void for_each(F f) {
+		for (auto &j : jobs) {
+			j.second.update();
+			f(j.second);
+		}
+	}
+};
+
+/*
+ * Register a page that can also be evaluated as a background job,
+ * when it is requested with the bg parameter set.
+ */
+void job_handle(const char *url, const char *title, SwillHandler h, void *data = NULL);
+// Display the status or the output of a job
+int job_page(FILE *of, void *);
+// Output a job's state and progress as plain text
+int job_status_page(FILE *of, void *);
+// List the background jobs
+int jobs_page(FILE *of, void *);
+
+#endif // JOB_
@@ -0,0 +1,209 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Streaming output of JSON values
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+#include "json.h"
+
+/*
+ * Return the length of the valid UTF-8 sequence starting at s[i],
+ * or 0 if the bytes there do not form one.
+ */
+static size_t
+utf8_length(const string &s, size_t i)
+{
+	unsigned char c = s[i];
+	size_t len;
+	unsigned long cp, min;
+
+	if (c < 0x80)
+		return 1;
+	else if ((c & 0xe0) == 0xc0) {
+		len = 2;
+		cp = c & 0x1f;
+		min = 0x80;
+	} else if ((c & 0xf0) == 0xe0) {
+		len = 3;
+		cp = c & 0x0f;
+		min = 0x800;
+	} else if ((c & 0xf8) == 0xf0) {
+		len = 4;
+		cp = c & 0x07;
+		min = 0x10000;
+	} else
+		return 0;
+	if (i + len > s.length())
+		return 0;
+	for (size_t j = 1; j < len; j++) {
+		unsigned char cc = s[i + j];
+		if ((cc & 0xc0) != 0x80)
+			return 0;
+		cp = (cp << 6) | (cc & 0x3f);
+	}
+	// Overlong encodings, surrogates, and values beyond Unicode
+	if (cp < min || (cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff)
+		return 0;
+	return len;
+}
+
+/*
+ * JSON text must be valid UTF-8.  Bytes that are not part of a
+ * UTF-8 sequence, such as those of source files in ISO-8859-1,
+ * are output as the ISO-8859-1 character they represent.
+ */
+string
+JsonWriter::quote(const string &s)
+{
+	string r("\"");
+	for (size_t i = 0; i < s.length(); i++) {
+		unsigned char c = s[i];
+		size_t len;
+		switch (c) {
+		case '"': r += "\\\""; break;
+		case '\\': r += "\\\\"; break;
+		case '\n': r += "\\n"; break;
+		case '\t': r += "\\t"; break;
+		default:
+			if (c >= 0x80 && (len = utf8_length(s, i)) > 0) {
+				r.append(s, i, len);
+				i += len - 1;
+			} else if (c < ' ' || c >= 0x80) {
+				char buff[10];
+				snprintf(buff, sizeof(buff), "\\u%04x", c);
+				r += buff;
+			} else
+				r += c;
+		}
+	}
+	return r + '"';
+}
+
+void
+JsonWriter::separate()
+{
+	if (after_key) {
+		after_key = false;
+		return;
+	}
+	if (open.empty())
+		return;
+	Container &c = open.back();
+	if (!c.empty)
+		fputc(',', of);
+	if (c.array)
+		fputc('\n', of);
+	c.empty = false;
+}
+
+JsonWriter &
+JsonWriter::begin(bool array, char c)
+{
+	separate();
+	fputc(c, of);
+	open.push_back(Container{array, true});
+	return *this;
+}
+
+JsonWriter &
+JsonWriter::end(char c)
+{
+	if (open.back().array && !open.back().empty)
+		fputc('\n', of);
+	open.pop_back();
+	fputc(c, of);
+	if (open.empty())
+		fputc('\n', of);
+	return *this;
+}
+
+JsonWriter &
+JsonWriter::key(const string &k)
+{
+	separate();
+	fputs(quote(k).c_str(), of);
+	fputc(':', of);
+	after_key = true;
+	return *this;
+}
+
+JsonWriter &
+JsonWriter::value(const string &s)
+{
+	separate();
+	fputs(quote(s).c_str(), of);
+	return *this;
+}
+
+JsonWriter &
+JsonWriter::value(bool b)
+{
+	separate();
+	fputs(b ? "true" : "false", of);
+	return *this;
+}
+
+// JSON has no representation for infinities and NaNs
+JsonWriter &
+JsonWriter::value(double d)
+{
+	if (!std::isfinite(d))
+		return null();
+	separate();
+	fprintf(of, "%.15g", d);
+	return *this;
+}
+
+JsonWriter &
+JsonWriter::number(long long v)
+{
+	separate();
+	fprintf(of, "%lld", v);
+	return *this;
+}
+
+JsonWriter &
+JsonWriter::number(unsigned long long v)
+{
+	separate();
+	fprintf(of, "%llu", v);
+	return *this;
+}
+
+JsonWriter &
+JsonWriter::value(const void *p)
+{
+	char buff[32];
+	snprintf(buff, sizeof(buff), "%p", p);
+	return value(string(buff));
+}
+
+JsonWriter &
+JsonWriter::null()
+{
+	separate();
+	fputs("null", of);
+	return *this;
+}
@@ -0,0 +1,91 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Streaming output of JSON values
+ *
+ */
+
+#ifndef JSON_
+#define JSON_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+using namespace std;
+
+/*
+ * A writer of JSON text, which outputs values as they are
+ * generated, without building them in memory.
+ * The writer keeps track of the open containers in order to
+ * separate their elements.  Members are written by calling key()
+ * followed by the output of the member's value.
+ * Array elements are output on separate lines, so that long
+ * result lists can be processed as they arrive.
+ */
+class JsonWriter {
+	FILE *of;
+	struct Container {
+		bool array;	// True for arrays, false for objects
+		bool empty;	// True if no elements have been output
+	};
+	vector <Container> open;	// Containers being output
+	bool after_key;		// A member's key has just been written
+	// Start and end a container
+	JsonWriter &begin(bool array, char c);
+	JsonWriter &end(char c);
+	// Separate the value about to be output from the previous one
+	void separate();
+	JsonWriter &number(long long v);
+	JsonWriter &number(unsigned long long v);
+public:
+	JsonWriter(FILE *f) : of(f), after_key(false) {}
+
+	JsonWriter &begin_object() { return begin(false, '{'); }
+	JsonWriter &end_object() { return end('}'); }
+	JsonWriter &begin_array() { return begin(true, '['); }
+	JsonWriter &end_array() { return end(']'); }
+	JsonWriter &key(const string &k);
+
+	JsonWriter &value(const string &s);
+	JsonWriter &value(const char *s) { return value(string(s)); }
+	JsonWriter &value(bool b);
+	JsonWriter &value(double d);
+	JsonWriter &value(int v) { return number((long long)v); }
+	JsonWriter &value(long v) { return number((long long)v); }
+	JsonWriter &value(long long v) { return number(v); }
+	JsonWriter &value(unsigned v) { return number((unsigned long long)v); }
+	JsonWriter &value(unsigned long v) { return number((unsigned long long)v); }
+	JsonWriter &value(unsigned long long v) { return number(v); }
+	// Pointers are output as strings, in the form used in URLs
+	JsonWriter &value(const void *p);
+	JsonWriter &null();
+
+	// Output a member of an object
+	template <typename T>
+	JsonWriter &member(const string &k, const T &v) {
+		key(k);
+		return value(v);
+	}
+
+	// Return s as a quoted JSON string
+	static string quote(const string &s);
+};
+
+#endif // JSON_
@@ -0,0 +1,361 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Microbenchmarks of CScout's core processing kernels.
+ * Each kernel is run in isolation over synthetic input, and its
+ * time and memory allocations are reported per operation.
+ *
+ * Usage: kbench [-n count] [kernel ...]
+ *
+ */
+
+#include <map>
+#include <string>
+#include <deque>
+#include <vector>
+#include <stack>
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <set>
+#include <chrono>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <getopt.h>
+
+#include "cpp.h"
+#include "debug.h"
+#include "error.h"
+#include "parse.tab.h"
+#include "attr.h"
+#include "metrics.h"
+#include "fileid.h"
+#include "tokid.h"
+#include "token.h"
+#include "ptoken.h"
+#include "fchar.h"
+#include "pltoken.h"
+#include "macro.h"
+#include "pdtoken.h"
+#include "eclass.h"
+#include "type.h"
+#include "stab.h"
+#include "idquery.h"
+#include "sql.h"
+
+// Normally defined in cscout.cpp, which is not linked with the benchmark
+Attributes::size_type current_project;
+
+/*
+ * Count all memory allocations by replacing the global allocation
+ * functions.  The benchmark is single-threaded.
+ */
+static unsigned long long allocations, allocated_bytes;
+
+void *
+operator new(size_t n)
+{
+	allocations++;
+	allocated_bytes += n;
+	void *p = malloc(n ? n : 1);
+	if (p == NULL)
+		throw bad_alloc();
+	return p;
+}
+
+void *
+operator new[](size_t n)
+{
+	return operator new(n);
+}
+
+void
+operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void
+operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void
+operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void
+operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+
+// Kernels to run; all if empty
+static set <string> selected;
+
+/*
+ * Run f, which returns the number of operations it performed,
+ * and report its cost per operation
+ */
+template <typename F>
+static void
+measure(const char *name, F f)
+{
+	if (!selected.empty() && selected.find(name) == selected.end())
+		return;
+	unsigned long long alloc0 = allocations, bytes0 = allocated_bytes;
+	auto start = chrono::steady_clock::now();
+	unsigned long n = f();
+	chrono::duration<double, nano> d(chrono::steady_clock::now() - start);
+	if (n == 0)
+		n = 1;
+	printf("%-16s %10lu %12.1f %10.2f %12.1f\n", name, n,
+	    d.count() / n,
+	    (double)(allocations - alloc0) / n,
+	    (double)(allocated_bytes - bytes0) / n);
+}
+
+// Create the file named fname with the contents s
+static void
+create_file(const char *fname, const string &s)
+{
+	ofstream out(fname, ios::binary);
+	out << s;
+	if (!out) {
+		perror(fname);
+		exit(1);
+	}
+}
+
+// Lex the file fname into a sequence of tokens, returning their number
+static unsigned long
+lex_file(const char *fname, PtokenSequence *tokens = NULL)
+{
+	unsigned long n = 0;
+	Fchar::set_input(fname);
+	Pltoken::set_context(cpp_normal);
+	for (;;) {
+		Pltoken t;
+		t.getnext<Fchar>();
+		if (t.get_code() == EOF)
+			break;
+		n++;
+		if (tokens && !t.is_space())
+			tokens->push_back(t);
+	}
+	return n;
+}
+
+// Return the identifiers among the tokens
+static vector <Ptoken>
+identifiers(const PtokenSequence &tokens)
+{
+	vector <Ptoken> r;
+	for (const Ptoken &t : tokens)
+		if (t.get_code() == IDENTIFIER)
+			r.push_back(t);
+	return r;
+}
+
+static const char lex_file_name[] = "kbench-lex.c";
+static const char unify_file_name[] = "kbench-unify.c";
+static const char macro_def_file_name[] = "kbench-mdef.c";
+static const char macro_use_file_name[] = "kbench-muse.c";
+
+int
+main(int argc, char *argv[])
+{
+	unsigned long n = 100000;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:")) != EOF)
+		switch (c) {
+		case 'n':
+			n = strtoul(optarg, NULL, 10);
+			if (n == 0) {
+				cerr << "The count must be positive" << endl;
+				exit(1);
+			}
+			break;
+		default:
+			cerr << "Usage: " << argv[0] << " [-n count] [kernel ...]" << endl;
+			exit(1);
+		}
+	for (; optind < argc; optind++)
+		selected.insert(argv[optind]);
+
+	Pdtoken init;
+	Project::set_current_project("kbench");
+
+	// Source code with about n tokens
+	string src;
+	for (unsigned long i = 0; src.length() < n * 4; i++)
+		src += "int v" + to_string(i) + " = f" + to_string(i % 97) +
+		    "(a, b->c[2]) + 0x2a; /* note */\n";
+	create_file(lex_file_name, src);
+	cs_offset_t lex_size = src.length();
+
+	// Pairs of identifiers to unify
+	src.clear();
+	for (unsigned long i = 0; i < n; i++)
+		src += "id" + to_string(i) + " id" + to_string(i) + "\n";
+	create_file(unify_file_name, src);
+
+	// Nested and token-pasting macros
+	create_file(macro_def_file_name,
+	    "#define M0(x) ((x) + 1)\n"
+	    "#define M1(x) M0(M0(x))\n"
+	    "#define M2(x) M1(x) * M1(x)\n"
+	    "#define M3(x) M2(x) - M2(x)\n"
+	    "#define OBJ M3(y)\n"
+	    "#define CAT(a, b) a ## b\n"
+	    "#define STR(x) #x\n"
+	    "#define CALL(f, ...) f(__VA_ARGS__)\n");
+	create_file(macro_use_file_name,
+	    "M3(a) OBJ CAT(foo, bar) STR(hello) CALL(g, 1, 2)\n");
+
+	printf("%-16s %10s %12s %10s %12s\n", "Kernel", "Ops", "ns/op",
+	    "allocs/op", "bytes/op");
+
+	measure("lex", [&]() { return lex_file(lex_file_name); });
+	// Relexing finds the equivalence classes already in place
+	measure("relex", [&]() { return lex_file(lex_file_name); });
+
+	PtokenSequence tokens;
+	lex_file(lex_file_name, &tokens);
+	vector <Ptoken> ids(identifiers(tokens));
+	vector <string> names;
+	for (const Ptoken &t : ids)
+		names.push_back(t.get_name());
+
+	// Define the macros
+	Fchar::set_input(macro_def_file_name);
+	for (;;) {
+		Pdtoken t;
+		t.getnext();
+		if (t.get_code() == EOF)
+			break;
+	}
+	PtokenSequence use;
+	lex_file(macro_use_file_name, &use);
+	unsigned long nexpand = n / 100 + 1;
+	measure("macro_expand", [&]() {
+		for (unsigned long i = 0; i < nexpand; i++)
+			macro_expand(use, Macro::TokenSourceOption::use_supplied,
+			    Macro::DefinedHandlingOption::process,
+			    Macro::CalledContext::process_c);
+		return nexpand;
+	});
+
+	PtokenSequence pairs;
+	lex_file(unify_file_name, &pairs);
+	vector <Ptoken> pair_ids(identifiers(pairs));
+	measure("unify", [&]() {
+		for (size_t i = 0; i + 1 < pair_ids.size(); i += 2)
+			Token::unify(pair_ids[i], pair_ids[i + 1]);
+		return pair_ids.size() / 2;
+	});
+
+	/*
+	 * Equivalence classes with four members each, placed at offsets
+	 * past the end of the lexed file
+	 */
+	Fileid fi(lex_file_name);
+	const int eclen = 8;
+	cs_offset_t base = lex_size + 1024;
+	auto make_ecs = [&](unsigned long count) {
+		vector <Eclass *> r;
+		r.reserve(count);
+		for (unsigned long i = 0; i < count; i++) {
+			Eclass *e = new Eclass(Tokid(fi, base), eclen);
+			for (int j = 1; j < 4; j++)
+				e->add_tokid(Tokid(fi, base + j * eclen));
+			base += 4 * eclen;
+			r.push_back(e);
+		}
+		return r;
+	};
+	vector <Eclass *> ecs(make_ecs(n));
+	measure("ec_merge", [&]() {
+		for (unsigned long i = 0; i + 1 < n; i += 2)
+			merge(ecs[i], ecs[i + 1]);
+		return n / 2;
+	});
+	ecs = make_ecs(n);
+	measure("ec_split", [&]() {
+		for (Eclass *e : ecs)
+			e->split(eclen / 2);
+		return n;
+	});
+
+	measure("constituents", [&]() {
+		for (unsigned long i = 0; i < n; i++) {
+			size_t k = i % ids.size();
+			ids[k].get_parts_begin()->get_tokid().constituents(names[k].length());
+		}
+		return n;
+	});
+
+	Stab stab;
+	for (const Ptoken &t : ids)
+		stab.define(t, basic(b_int));
+	const string miss("x");
+	measure("stab_lookup", [&]() {
+		// Alternate between hits and misses
+		for (unsigned long i = 0; i < n; i++)
+			stab.lookup(i % 2 ? names[(i / 2) % names.size()] : miss);
+		return n;
+	});
+
+	for (size_t k = 0; k < ids.size(); k++) {
+		Eclass *e = ids[k].get_parts_begin()->get_tokid().get_ec();
+		Identifier::ids[e] = Identifier(e, names[k]);
+	}
+	IdQuery query("L:writable:unused:macro");
+	measure("idquery_eval", [&]() {
+		IdProp::iterator i = Identifier::ids.begin();
+		for (unsigned long k = 0; k < n; k++) {
+			query.eval(*i);
+			if (++i == Identifier::ids.end())
+				i = Identifier::ids.begin();
+		}
+		return n;
+	});
+
+	if (!Sql::setEngine("sqlite"))
+		return 1;
+	const string text("It's a \"quoted\" string\\with\tspecial characters");
+	measure("sql_escape", [&]() {
+		for (unsigned long i = 0; i < n; i++)
+			Sql::getInterface()->escape(text);
+		return n;
+	});
+
+	remove(lex_file_name);
+	remove(unify_file_name);
+	remove(macro_def_file_name);
+	remove(macro_use_file_name);
+	return 0;
+}
@@ -38,6 +38,7 @@
 #include "pltoken.h"
 #include "macro.h"
 #include "pdtoken.h"
+#include "profile.h"
 #include "tchar.h"
 #include "ctoken.h"
 #include "type.h"
@@ -598,6 +599,7 @@ macro_expand(PtokenSequence ts,
 				<< ts
 				<< nest_end("]");
 		expanded_macros.insert(m);
+		Profile::count(Profile::pc_macro_expansions);
 		PtokenSequence removed_spaces;
 		if (!m.is_function) {
 			// Object-like macro
@@ -0,0 +1,186 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Accounting of the memory used by the major data structures
+ *
+ */
+
+#include <map>
+#include <string>
+#include <deque>
+#include <vector>
+#include <stack>
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <set>
+
+#if defined(HAVE_JEMALLOC)
+#include <jemalloc/jemalloc.h>
+#elif defined(HAVE_TCMALLOC)
+#include <gperftools/malloc_extension.h>
+#include <gperftools/heap-profiler.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "cpp.h"
+#include "debug.h"
+#include "error.h"
+#include "attr.h"
+#include "metrics.h"
+#include "fileid.h"
+#include "tokid.h"
+#include "token.h"
+#include "parse.tab.h"
+#include "ptoken.h"
+#include "fchar.h"
+#include "pltoken.h"
+#include "macro.h"
+#include "pdtoken.h"
+#include "eclass.h"
+#include "type.h"
+#include "call.h"
+#include "globobj.h"
+#include "filedetails.h"
+#include "idquery.h"
+#include "ctag.h"
+#include "engine.h"
+#include "projindex.h"
+#include "memstat.h"
+
+size_t
+MemoryStats::total_bytes() const
+{
+	size_t total = 0;
+	for (const Entry &e : entries)
+		total += e.bytes;
+	return total;
+}
+
+MemoryStats
+MemoryStats::collect()
+{
+	MemoryStats s;
+
+	Tokid::memory_stats(s);
+	Eclass::memory_stats(s);
+	Identifier::memory_stats(s);
+	Call::memory_stats(s);
+	GlobObj::memory_stats(s);
+	Filedetails::memory_stats(s);
+	Pdtoken::memory_stats(s);
+	CTag::memory_stats(s);
+	ProjectIndex::memory_stats(s);
+	s.add("Function call refactorings", RefFunCall::store.size(),
+	    node_bytes(RefFunCall::store));
+	// Type nodes vary in size; count the common part
+	s.add("Type nodes", Type_node::get_count(),
+	    Type_node::get_count() * sizeof(Type_node));
+	return s;
+}
+
+#if defined(HAVE_JEMALLOC)
+
+size_t
+heap_in_use()
+{
+	// Refresh the statistics
+	uint64_t epoch = 1;
+	size_t len = sizeof(epoch);
+	mallctl("epoch", &epoch, &len, &epoch, len);
+
+	size_t allocated;
+	len = sizeof(allocated);
+	if (mallctl("stats.allocated", &allocated, &len, NULL, 0) != 0)
+		return 0;
+	return allocated;
+}
+
+bool
+heap_profile_available()
+{
+	bool prof;
+	size_t len = sizeof(prof);
+	return mallctl("opt.prof", &prof, &len, NULL, 0) == 0 && prof;
+}
+
+bool
+heap_profile_dump(const string &fname)
+{
+	const char *name = fname.c_str();
+	return mallctl("prof.dump", NULL, NULL, &name, sizeof(name)) == 0;
+}
+
+#elif defined(HAVE_TCMALLOC)
+
+size_t
+heap_in_use()
+{
+	size_t allocated;
+	if (!MallocExtension::instance()->GetNumericProperty(
+	    "generic.current_allocated_bytes", &allocated))
+		return 0;
+	return allocated;
+}
+
+// The profiler is started by setting the HEAPPROFILE environment variable
+bool
+heap_profile_available()
+{
+	return IsHeapProfilerRunning();
+}
+
+// The profile is written to a file whose name is derived from HEAPPROFILE
+bool
+heap_profile_dump(const string &fname)
+{
+	if (!IsHeapProfilerRunning())
+		return false;
+	HeapProfilerDump(fname.c_str());
+	return true;
+}
+
+#else
+
+size_t
+heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 mi = mallinfo2();
+	// Bytes in allocated chunks and in mmapped regions
+	return mi.uordblks + mi.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+bool
+heap_profile_available()
+{
+	return false;
+}
+
+bool
+heap_profile_dump(const string &)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Accounting of the memory used by the major data structures
+ *
+ */
+
+#ifndef MEMSTAT_
+#define MEMSTAT_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/*
+ * Element counts and estimated heap sizes of data structures.
+ * The sizes are estimates based on the element sizes and the
+ * typical per-node overhead of the standard library containers;
+ * they do not account for allocator overhead and fragmentation.
+ */
+class MemoryStats {
+public:
+	struct Entry {
+		string name;		// Data structure
+		size_t count;		// Number of elements
+		size_t bytes;		// Estimated size
+	};
+private:
+	vector <Entry> entries;
+public:
+	void add(const string &name, size_t count, size_t bytes) {
+		entries.push_back(Entry{name, count, bytes});
+	}
+	vector <Entry>::const_iterator begin() const { return entries.begin(); }
+	vector <Entry>::const_iterator end() const { return entries.end(); }
+	size_t total_bytes() const;
+
+	// Collect the statistics of all the major data structures
+	static MemoryStats collect();
+};
+
+// Per-node overhead of the tree-based associative containers
+const size_t tree_node_overhead = 4 * sizeof(void *);
+
+// Estimated heap size of a tree-based associative container's nodes
+template <typename C>
+size_t
+node_bytes(const C &c)
+{
+	return c.size() * (sizeof(typename C::value_type) + tree_node_overhead);
+}
+
+// Heap size of a vector's elements
+template <typename T>
+size_t
+vector_bytes(const vector <T> &v)
+{
+	return v.capacity() * sizeof(T);
+}
+
+inline size_t
+vector_bytes(const vector <bool> &v)
+{
+	return v.capacity() / 8;
+}
+
+// Capacity of strings stored in place, without a heap allocation
+const size_t string_local_capacity = 15;
+
+// Heap size of a string's contents
+inline size_t
+string_bytes(const string &s)
+{
+	return s.capacity() > string_local_capacity ? s.capacity() + 1 : 0;
+}
+
+/*
+ * Return the number of bytes the allocator reports as being in use,
+ * or 0 if this is not available.
+ */
+size_t heap_in_use();
+
+// True if a heap profile can be dumped
+bool heap_profile_available();
+
+/*
+ * Dump a heap profile through the allocator, returning false
+ * on failure.  The file name argument is a hint; some allocators
+ * use their own naming scheme.
+ */
+bool heap_profile_dump(const string &fname);
+
+#endif // MEMSTAT_
@@ -69,6 +69,8 @@ TextOption *Option::sfile_re_string;		// Saved files replacement location RE str
 TextOption *Option::sfile_repl_string;		// Saved files replacement string
 TextOption *Option::start_editor_cmd;		// Command to invoke an external editor
 IntegerOption *Option::entries_per_page;	// Number of elements to show in a page
+IntegerOption *Option::query_time_limit;	// Seconds a query can run
+IntegerOption *Option::query_result_limit;	// Results a query can return
 IntegerOption *Option::cgraph_depth;		// How deep to descend in a call graph
 IntegerOption *Option::fgraph_depth;		// How deep to descend in an include graph
 BoolOption *Option::cgraph_dot_url;		// Include URLs in dot output
@@ -230,6 +232,8 @@ Option::initialize()
 
 	Option::add(new TitleOption("Queries"));
 	Option::add(file_icase = new BoolOption("file_icase", "Case-insensitive file name regular expression match"));
+	Option::add(query_time_limit = new IntegerOption("query_time_limit", "Maximum query evaluation time in seconds (0 for no limit)", 0));
+	Option::add(query_result_limit = new IntegerOption("query_result_limit", "Maximum number of query results or graph elements (0 for no limit)", 0));
 
 	Option::add(new TitleOption("Query Result Lists"));
 	Option::add(entries_per_page = new IntegerOption("entries_per_page", "Number of entries on a page", 50));
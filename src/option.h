@@ -101,6 +101,8 @@ public:
 	static TextOption *sfile_repl_string;		// Saved files replacement string
 	static TextOption *start_editor_cmd;		// Command to invoke an external editor
 	static IntegerOption *entries_per_page;		// Number of elements to show in a page
+	static IntegerOption *query_time_limit;		// Seconds a query can run
+	static IntegerOption *query_result_limit;	// Results a query can return
 	static IntegerOption *cgraph_depth;		// How deep to descend in a call graph
 	static IntegerOption *fgraph_depth;		// How deep to descend in a file graph
 	static BoolOption *cgraph_dot_url;		// Include URLs in dot output
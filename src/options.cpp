@@ -41,6 +41,7 @@
 #include "dbtoken.h"
 #include "options.h"
 #include "util.h"
+#include "profile.h"
 
 using namespace std;
 
@@ -55,7 +56,7 @@ usage(char *fname)
 #endif
 		"-C|-c|-d D|-d H|-E RE|-o|-M files|"
 		"-q|-R URL|-r|-S db|-s db|-v] "
-		"[-l file] "
+		"[-K] [-l file] "
 
 #ifdef PICO_QL
 #define PICO_QL_OPTIONS "q"
@@ -64,9 +65,11 @@ usage(char *fname)
 #define PICO_QL_OPTIONS ""
 #endif
 
-		"[-P RE] [-p port] [-m spec] [-t table ...] file\n"
+		"[-P RE] [-p port] [-m spec] [-T format:file] [-t table ...] [-w workers] [-z] file\n"
 #ifndef WIN32
 		"\t-b\tRun in multiuser browse-only mode\n"
+		"\t-w workers\tServe browse-only requests through the specified\n"
+		"\t\tnumber of pre-forked worker processes\n"
 #endif
 		"\t-C\tCreate a ctags(1)-compatible tags file\n"
 		"\t-c\tProcess the file and exit\n"
@@ -75,6 +78,8 @@ usage(char *fname)
 		"\t-d H\tOutput the names of included files being processed\n"
 		"\t-E RE\tOutput preprocessed results and exit\n"
 		"\t\t(Will process file(s) matched by the regular expression)\n"
+		"\t-K\tKeep the parser state and the mutable form of the\n"
+		"\t\tdata structures after processing\n"
 		"\t-l file\tSpecify access log file\n"
 		"\t-M files\tMerge specified EC files\n"
 		"\t-m spec\tSpecify identifiers to monitor (unsound)\n"
@@ -90,9 +95,16 @@ usage(char *fname)
 		"\t-r\tGenerate an identifier and include file warning report\n"
 		"\t-S db\tGenerate the SQL schema for the specified RDBMS\n"
 		"\t-s db\tGenerate SQL output for the specified RDBMS\n"
+#ifdef HAVE_SQLITE
+		"\t\t(Specify sqlite:FILE to write directly into an SQLite database)\n"
+#endif
+		"\t-T format:file\tWrite a profiling report of the processing phases\n"
+		"\t\tto the specified file (format is json or csv)\n"
 		"\t-t table\tEnable population of the specified RDBMS table\n"
 		"\t\t(All enabled by default. Option can be provided multiple times)\n"
 		"\t-v\tDisplay version and copyright information and exit\n"
+		"\t-z\tStore the RDBMS TOKENS and LINEPOS tables in compact form\n"
+		"\t\t(Must precede -S)\n"
 		"\t-3\tEnable the handling of trigraph characters\n"
 		;
 	exit(1);
@@ -118,7 +130,7 @@ CscoutOptions::parse_args(int argc, char *argv[])
 {
     int c;
 
-	while ((c = getopt(argc, argv, "3bCcd:rvE:P:p:Mm:l:oR:S:s:t:q" PICO_QL_OPTIONS)) != EOF)  //added q for quiet
+	while ((c = getopt(argc, argv, "3bCcd:rvE:KP:p:Mm:l:oR:S:s:T:t:w:zq" PICO_QL_OPTIONS)) != EOF)  //added q for quiet
 		switch (c) {
 		case '3':
 			Fchar::enable_trigraphs();
@@ -136,6 +148,8 @@ CscoutOptions::parse_args(int argc, char *argv[])
 		#ifdef PICO_QL
 		case 'q':
 			pico_ql = true;
+			// The query interface accesses the token map directly
+			freeze = false;
 			/* FALLTHROUGH */
 		#endif
 		case 'c':
@@ -183,6 +197,13 @@ CscoutOptions::parse_args(int argc, char *argv[])
 		case 'b':
 			this->browse_only = true;
 			break;
+		case 'w':
+			if (!optarg)
+				usage(argv[0]);
+			nworkers = atoi(optarg);
+			if (nworkers < 1)
+				usage(argv[0]);
+			break;
 		case 'q':
 			quiet = true;
 			break;
@@ -211,6 +232,7 @@ CscoutOptions::parse_args(int argc, char *argv[])
 			if (!Sql::setEngine(optarg))
 				exit(1);
 			workdb_schema(Sql::getInterface(), cout);
+			workdb_keys(Sql::getInterface(), cout);
 			exit(0);
 		case 's':
 			if (process_mode)
@@ -220,11 +242,21 @@ CscoutOptions::parse_args(int argc, char *argv[])
 			process_mode = pm_database;
 			db_engine = optarg;
 			break;
+		case 'T':
+			if (!optarg || !Profile::enable(optarg))
+				usage(argv[0]);
+			break;
 		case 't':
 			if (!optarg)
 				usage(argv[0]);
 			table_enable(optarg);
 			break;
+		case 'z':
+			workdb_set_compact();
+			break;
+		case 'K':
+			freeze = false;
+			break;
 		case 'R':
 			if (!optarg)
 				usage(argv[0]);
@@ -48,18 +48,22 @@ public:
 	std::string db_engine;
 	IdQuery monitor;
 	bool browse_only;
+	int nworkers;		// Browse-only worker processes (0: fork per request)
 	std::vector<std::string> call_graphs;
 	std::string log_file;
 	bool do_merge;
 	bool pico_ql;
+	bool freeze;		// Compact the data structures after processing
 
 	CscoutOptions() :
 		process_mode(pm_server),
 		portno(8081),
 		quiet(false),
 		browse_only(false),
+		nworkers(0),
 		do_merge(false),
-		pico_ql(false)
+		pico_ql(false),
+		freeze(true)
 	{}
 
 	void parse_args(int argc, char *argv[]);
@@ -94,6 +94,7 @@ is_absolute_filename(const string &s)
 #include <stdio.h>
 #include <unistd.h>
 #include <limits.h>
+#include <sys/syscall.h>
 
 char *
 get_uniq_fname_string(const char *name)
@@ -137,5 +138,19 @@ is_absolute_filename(const string &s)
 {
 	return s.length() > 0 && s[0] == '/';
 }
+
+void
+close_fds(int lo, int hi)
+{
+	if (lo > hi)
+		return;
+#ifdef SYS_close_range
+	if (syscall(SYS_close_range, (unsigned)lo, (unsigned)hi, 0) == 0)
+		return;
+#endif
+	// Not supported by the system; close them one by one
+	for (int i = lo, max = sysconf(_SC_OPEN_MAX); i <= hi && i < max; i++)
+		close(i);
+}
 #endif /* unix */
 
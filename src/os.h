@@ -34,5 +34,7 @@ const char *get_uniq_fname_string(const char *pathname);
 const char *get_full_path(const char *pathname);
 // Return true if pathname is an absolute file path
 bool is_absolute_filename(const string &pathname);
+// Close the file descriptors from lo to hi inclusive (Unix-specific)
+void close_fds(int lo, int hi);
 
 #endif // OS_
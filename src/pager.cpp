@@ -33,13 +33,17 @@
 #include "cpp.h"
 #include "debug.h"
 #include "pager.h"
+#include "job.h"
 
 Pager::Pager(FILE *f, int ps, const string &qurl, bool bmk) : of(f), pagesize(ps), current(0), url(qurl), bookmarkable(bmk)
 {
+	// Background jobs produce the complete listing
 	if (!swill_getargs("I(skip)", &skip))
-		skip = 0;
+		skip = Job::is_job() ? -1 : 0;
 }
 
+unsigned QueryCacheBase::current_generation;
+
 bool
 Pager::show_next()
 {
@@ -48,6 +52,15 @@ Pager::show_next()
 	return (ret);
 }
 
+pair <int, int>
+Pager::page_range(int n)
+{
+	current = n;
+	if (skip == -1)
+		return make_pair(0, n);
+	return make_pair(max(0, min(skip, n)), max(0, min(skip + pagesize, n)));
+}
+
 void
 Pager::end()
 {
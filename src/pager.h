@@ -26,6 +26,11 @@
 
 #include <string>
 #include <cstdio>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+#include <utility>
 
 using namespace std;
 
@@ -40,7 +45,86 @@ private:
 public:
 	Pager(FILE *f, int ps, const string &qurl, bool bmk);
 	bool show_next();
+	// Return the range [first, last) of n elements to show on the page
+	pair <int, int> page_range(int n);
 	void end();
 };
 
+// Common invalidation of all query result caches
+class QueryCacheBase {
+protected:
+	static unsigned current_generation;	// Incremented on invalidation
+public:
+	// Called when the workspace or the way it is queried changes
+	static void invalidate() { current_generation++; }
+};
+
+/*
+ * A bounded least recently used cache of results, such as sorted
+ * query results keyed by the query's URL and the current project.
+ * This allows paging through the results without reevaluating the query.
+ * Results are shared, so that an entry can be evicted while a page
+ * is displaying it.
+ */
+template <typename R>
+class ResultCache : public QueryCacheBase {
+public:
+	typedef R Result;
+	typedef shared_ptr <const Result> ResultPtr;
+private:
+	typedef list <pair <string, ResultPtr> > Entries;
+	Entries entries;		// Most recently used first
+	map <string, typename Entries::iterator> index;
+	unsigned generation;		// Generation of the cached entries
+	unsigned max_entries;		// Number of entries to keep
+
+	void clear_stale() {
+		if (generation == current_generation)
+			return;
+		entries.clear();
+		index.clear();
+		generation = current_generation;
+	}
+public:
+	ResultCache(unsigned n) : generation(current_generation), max_entries(n) {}
+
+	// Return the results cached under key, or nullptr
+	ResultPtr get(const string &key) {
+		clear_stale();
+		auto i = index.find(key);
+		if (i == index.end())
+			return nullptr;
+		entries.splice(entries.begin(), entries, i->second);
+		return i->second->second;
+	}
+
+	/*
+	 * Cache the results r under key and return them.
+	 * Incomplete results, such as those truncated by a query's
+	 * budget, are returned without being cached.
+	 */
+	ResultPtr put(const string &key, Result &&r, bool complete = true) {
+		if (!complete)
+			return make_shared<const Result>(std::move(r));
+		clear_stale();
+		auto i = index.find(key);
+		if (i != index.end()) {
+			entries.erase(i->second);
+			index.erase(i);
+		}
+		ResultPtr p(make_shared<const Result>(std::move(r)));
+		entries.emplace_front(key, p);
+		index[key] = entries.begin();
+		if (entries.size() > max_entries) {
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+		return p;
+	}
+};
+
+// A cache of sorted query results
+template <typename T>
+using QueryCache = ResultCache <vector <T> >;
+
 #endif // PAGER_
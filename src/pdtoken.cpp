@@ -53,6 +53,7 @@
 #include "pltoken.h"
 #include "macro.h"
 #include "pdtoken.h"
+#include "profile.h"
 #include "tchar.h"
 #include "ctoken.h"
 #include "eval.h"
@@ -65,6 +66,7 @@
 #include "ctag.h"
 #include "type.h"		// stab.h
 #include "stab.h"		// Block::enter()
+#include "memstat.h"
 
 bool Pdtoken::at_bol = true;
 bool Pdtoken::output_defines = false;
@@ -762,8 +764,10 @@ Pdtoken::process_include(bool next)
 	// #include <foo.h> and #include "foo.h"
 	if (is_absolute_filename(f.get_val())) {
 		if (can_open(f.get_val())) {
-			if (!Pdtoken::shall_skip(Fileid(f.get_val())))
+			if (!Pdtoken::shall_skip(Fileid(f.get_val()))) {
 				Fchar::push_input(f.get_val());
+				Profile::count(Profile::pc_include_files);
+			}
 			return;
 		}
 	} else {
@@ -782,8 +786,10 @@ Pdtoken::process_include(bool next)
 		if (f.get_code() == ABSFNAME && !next) {
 			string fname(Fchar::get_dir() + "/" + f.get_val());
 			if (can_open(fname)) {
-				if (!Pdtoken::shall_skip(Fileid(fname)))
+				if (!Pdtoken::shall_skip(Fileid(fname))) {
 					Fchar::push_input(fname);
+					Profile::count(Profile::pc_include_files);
+				}
 				return;
 			}
 		}
@@ -795,8 +801,10 @@ Pdtoken::process_include(bool next)
 			string fname(*i + "/" + f.get_val());
 			if (DP()) cout << "Try open " << fname << "\n";
 			if (can_open(fname)) {
-				if (!Pdtoken::shall_skip(Fileid(fname)))
+				if (!Pdtoken::shall_skip(Fileid(fname))) {
 					Fchar::push_input(fname);
+					Profile::count(Profile::pc_include_files);
+				}
 				Filedetails::set_ipath_offset(Fchar::get_fileid(), i - include_path.begin());
 				return;
 			}
@@ -1199,9 +1207,15 @@ Pdtoken::process_pragma()
 			Fchar::lock_stack();
 			Block::param_clear();
 			Block::set_cu_file_id(Fchar::get_fileid());
-			if (parse_parse() != 0)
-				exit(1);
-			garbage_collect(Fileid(t.get_val()));
+			{
+				Profile::Phase p("parse", t.get_val());
+				if (parse_parse() != 0)
+					exit(1);
+			}
+			{
+				Profile::Phase p("garbage_collect", t.get_val());
+				garbage_collect(Fileid(t.get_val()));
+			}
 			Fchar::unlock_stack();
 		}
 	} else if (t.get_val() == "pushd") {
@@ -1426,6 +1440,30 @@ operator<<(ostream& o,const vectorPdtoken &dp)
 	return (o);
 }
 
+void
+Pdtoken::release()
+{
+	macros.clear();
+	macro_body_tokens.clear();
+	// Any remaining tokens, together with their hide sets
+	expand.clear();
+	vectorPdtoken().swap(current_line);
+	Tchar::clear();
+	clear_include();
+	clear_skipped();
+}
+
+void
+Pdtoken::memory_stats(MemoryStats &s)
+{
+	size_t bytes = node_bytes(macros);
+	for (const mapMacro::value_type &m : macros)
+		bytes += (m.second.get_value().size() +
+		    m.second.get_formal_args().size()) * sizeof(Ptoken);
+	s.add("Macros", macros.size(), bytes);
+	s.add("Macro body tokens", macro_body_tokens.size(),
+	    node_bytes(macro_body_tokens));
+}
 
 #ifdef UNIT_TEST
 
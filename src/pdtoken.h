@@ -55,6 +55,7 @@ typedef vector<Pdtoken> vectorPdtoken;
 
 
 class Macro;
+class MemoryStats;
 
 typedef map<string, Macro> mapMacro;
 
@@ -129,6 +130,8 @@ public:
 	}
 
 	// Return the number of defined macros
+	// Add the memory used by the macros to s
+	static void memory_stats(MemoryStats &s);
 	static mapMacro::size_type macros_size() {
 		return macros.size();
 	}
@@ -145,6 +148,8 @@ public:
 	static void add_include(const string& s) { include_path.push_back(s); };
 	// Clear the include path
 	static void clear_include() { include_path.clear(); };
+	// Release the state that is only needed while processing the source
+	static void release();
 	// Called when we start processing a new file
 	// or resume an old one.  We assume that files end in line
 	// boundaries, even when they lack an explicit newline at their end
@@ -29,6 +29,7 @@
 #include "fchar.h"
 #include "tokid.h"
 #include "ptoken.h"
+#include "profile.h"
 
 class Fchar;
 
@@ -101,6 +102,7 @@ Pltoken::getnext_analyze()
 	dequeTpart new_tokids;
 
 	parts.clear();
+	Profile::count(Profile::pc_tokens);
 	c0.getnext();
 	switch (c0.get_char()) {
 	/*
@@ -0,0 +1,228 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Instrumentation of the processing phases and a machine-readable
+ * report of their resource use
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+
+#include "profile.h"
+#include "memstat.h"
+#include "json.h"
+
+#if defined(unix) || defined(__unix__) || defined(__MACH__)
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#else
+#include <windows.h>
+#endif
+
+unsigned long long Profile::counters[pc_size];
+bool Profile::enabled;
+bool Profile::json;
+string Profile::report_file;
+Profile::Usage Profile::start;
+vector <Profile::Record> Profile::records;
+
+const char * const Profile::counter_names[pc_size] = {
+	"tokens",
+	"macro_expansions",
+	"ec_created",
+	"ec_merged",
+	"ec_split",
+	"include_files",
+	"bytes_reclaimed",
+};
+
+Profile::Usage
+Profile::Usage::now()
+{
+	Usage u;
+
+	u.wall = chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+#if defined(unix) || defined(__unix__) || defined(__MACH__)
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	u.user = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6;
+	u.system = ru.ru_stime.tv_sec + ru.ru_stime.tv_usec * 1e-6;
+#ifdef __MACH__
+	u.peak_rss = ru.ru_maxrss / 1024;	// Reported in bytes
+#else
+	u.peak_rss = ru.ru_maxrss;
+#endif
+#else
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time,
+	    &kernel_time, &user_time);
+	// FILETIME values are in 100ns units
+	u.user = ((double)user_time.dwHighDateTime * 4294967296. + user_time.dwLowDateTime) * 1e-7;
+	u.system = ((double)kernel_time.dwHighDateTime * 4294967296. + kernel_time.dwLowDateTime) * 1e-7;
+	u.peak_rss = 0;			// Not available
+#endif
+	memcpy(u.counters, Profile::counters, sizeof(u.counters));
+	return u;
+}
+
+Profile::Phase::Phase(const string &n, const string &u) :
+	name(n), unit(u)
+{
+	if (enabled)
+		begin = Usage::now();
+}
+
+Profile::Phase::~Phase()
+{
+	if (!enabled)
+		return;
+	Usage end(Usage::now());
+	Record r;
+	r.name = name;
+	r.unit = unit;
+	r.used.wall = end.wall - begin.wall;
+	r.used.user = end.user - begin.user;
+	r.used.system = end.system - begin.system;
+	r.used.peak_rss = end.peak_rss;
+	for (int i = 0; i < pc_size; i++)
+		r.used.counters[i] = end.counters[i] - begin.counters[i];
+	records.push_back(r);
+}
+
+bool
+Profile::enable(const string &spec)
+{
+	if (spec.compare(0, 5, "json:") == 0)
+		json = true;
+	else if (spec.compare(0, 4, "csv:") == 0)
+		json = false;
+	else
+		return false;
+	report_file = spec.substr(spec.find(':') + 1);
+	if (report_file.empty())
+		return false;
+	enabled = true;
+	start = Usage::now();
+	return true;
+}
+
+// Return s as a CSV field
+static string
+csv_field(const string &s)
+{
+	if (s.find_first_of(",\"\n") == string::npos)
+		return s;
+	string r("\"");
+	for (char c : s)
+		if (c == '"')
+			r += "\"\"";
+		else
+			r += c;
+	return r + '"';
+}
+
+/*
+ * The report is rewritten in full every time it is requested,
+ * so that it always reflects all phases completed so far.
+ * A final "total" phase covers the time since profiling was enabled.
+ * It is followed by the memory used by the major data structures;
+ * in CSV output this forms a second table, after an empty line.
+ */
+void
+Profile::write_report()
+{
+	if (!enabled)
+		return;
+
+	FILE *f = fopen(report_file.c_str(), "w");
+	if (f == NULL) {
+		cerr << "Unable to open profiling report file " << report_file <<
+			": " << strerror(errno) << endl;
+		return;
+	}
+
+	Usage end(Usage::now());
+	Record total;
+	total.name = "total";
+	total.used.wall = end.wall - start.wall;
+	total.used.user = end.user - start.user;
+	total.used.system = end.system - start.system;
+	total.used.peak_rss = end.peak_rss;
+	for (int i = 0; i < pc_size; i++)
+		total.used.counters[i] = end.counters[i] - start.counters[i];
+
+	if (json)
+		fputs("{\n\"phases\": [\n", f);
+	else {
+		fputs("phase,unit,wall,user,system,peak_rss_kb", f);
+		for (int i = 0; i < pc_size; i++)
+			fprintf(f, ",%s", counter_names[i]);
+		fputc('\n', f);
+	}
+	for (size_t n = 0; n <= records.size(); n++) {
+		const Record &r = n < records.size() ? records[n] : total;
+		if (json) {
+			fprintf(f, "{\"phase\": %s, \"unit\": %s, "
+			    "\"wall\": %.6f, \"user\": %.6f, \"system\": %.6f, "
+			    "\"peak_rss_kb\": %ld",
+			    JsonWriter::quote(r.name).c_str(), JsonWriter::quote(r.unit).c_str(),
+			    r.used.wall, r.used.user, r.used.system, r.used.peak_rss);
+			for (int i = 0; i < pc_size; i++)
+				fprintf(f, ", \"%s\": %llu", counter_names[i], r.used.counters[i]);
+			fputs(n < records.size() ? "},\n" : "}\n", f);
+		} else {
+			fprintf(f, "%s,%s,%.6f,%.6f,%.6f,%ld",
+			    csv_field(r.name).c_str(), csv_field(r.unit).c_str(),
+			    r.used.wall, r.used.user, r.used.system, r.used.peak_rss);
+			for (int i = 0; i < pc_size; i++)
+				fprintf(f, ",%llu", r.used.counters[i]);
+			fputc('\n', f);
+		}
+	}
+
+	MemoryStats ms(MemoryStats::collect());
+	if (json)
+		fputs("],\n\"memory\": [\n", f);
+	else
+		fputs("\nstructure,count,bytes\n", f);
+	for (const MemoryStats::Entry &e : ms) {
+		if (json)
+			fprintf(f, "{\"structure\": %s, \"count\": %zu, \"bytes\": %zu},\n",
+			    JsonWriter::quote(e.name).c_str(), e.count, e.bytes);
+		else
+			fprintf(f, "%s,%zu,%zu\n", csv_field(e.name).c_str(),
+			    e.count, e.bytes);
+	}
+	// The allocator's view, for comparison with the estimates
+	if (json)
+		fprintf(f, "{\"structure\": \"heap in use\", \"count\": 0, \"bytes\": %zu}\n]\n}\n",
+		    heap_in_use());
+	else
+		fprintf(f, "heap in use,0,%zu\n", heap_in_use());
+	if (fclose(f) != 0)
+		cerr << "Error writing profiling report file " << report_file <<
+			": " << strerror(errno) << endl;
+}
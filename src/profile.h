@@ -0,0 +1,97 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Instrumentation of the processing phases and a machine-readable
+ * report of their resource use
+ *
+ */
+
+#ifndef PROFILE_
+#define PROFILE_
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Profile {
+public:
+	// Event counters
+	enum e_counter {
+		pc_tokens,		// Tokens lexed
+		pc_macro_expansions,	// Macros expanded
+		pc_ec_created,		// Equivalence classes created
+		pc_ec_merged,		// Equivalence classes merged
+		pc_ec_split,		// Equivalence classes split
+		pc_include_files,	// Include files opened
+		pc_bytes_reclaimed,	// Estimated bytes released by compaction
+		pc_size
+	};
+
+	// Resources used up to a point in time
+	struct Usage {
+		double wall, user, system;	// Seconds
+		long peak_rss;			// Kilobytes
+		unsigned long long counters[pc_size];
+		static Usage now();
+	};
+
+	/*
+	 * Record the resources used during the object's lifetime as
+	 * a phase with the specified name and (optional) unit,
+	 * such as a compilation unit's path.
+	 */
+	class Phase {
+	private:
+		string name, unit;
+		Usage begin;
+	public:
+		Phase(const string &n, const string &u = "");
+		~Phase();
+	};
+
+	// Increment the counter c
+	static void count(e_counter c) { counters[c]++; }
+	// Increase the counter c by n
+	static void count(e_counter c, unsigned long long n) { counters[c] += n; }
+
+	/*
+	 * Enable profiling with the report specified as json:FILE
+	 * or csv:FILE.  Return false if the specification is invalid.
+	 */
+	static bool enable(const string &spec);
+	static bool is_enabled() { return enabled; }
+
+	// Write the report of the phases recorded so far, if enabled
+	static void write_report();
+private:
+	struct Record {
+		string name, unit;
+		Usage used;
+	};
+	static unsigned long long counters[pc_size];
+	static bool enabled;
+	static bool json;		// JSON rather than CSV output
+	static string report_file;
+	static Usage start;		// Usage when profiling was enabled
+	static vector <Record> records;
+	static const char * const counter_names[pc_size];
+};
+
+#endif // PROFILE_
@@ -26,21 +26,34 @@
 
  #include <iostream>
 
+ #include "job.h"
+
+
+ // display the progress of the n-th of total loop iterations (non-reentrant)
+ static inline void
+ progress(size_t n, size_t total)
+ {
+    static int opercent;
+
+    int percent = n * 100 / total;
+    if (percent != opercent) {
+            // Background jobs report their progress to the server
+            if (!Job::report_progress(percent))
+                std::cerr << '\r' << percent << '%' << std::flush;
+            opercent = percent;
+        }
+ }
 
  // display loop progress (non-reentrant)
  template <typename container>
  static void
  progress(typename container::const_iterator i, const container &c)
  {
-    static int count, opercent;
+    static size_t count;
 
     if (i == c.begin())
         count = 0;
-    int percent = ++count * 100 / c.size();
-    if (percent != opercent) {
-            std::cerr << '\r' << percent << '%' << std::flush;
-            opercent = percent;
-        }
+    progress(++count, c.size());
  }
 
  #endif /* PROGRESS_H */
\ No newline at end of file
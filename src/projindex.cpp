@@ -0,0 +1,106 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Per-project lists of identifiers, functions, and files
+ *
+ */
+
+#include <map>
+#include <set>
+#include <list>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include "cpp.h"
+#include "debug.h"
+#include "error.h"
+#include "attr.h"
+#include "metrics.h"
+#include "fileid.h"
+#include "tokid.h"
+#include "token.h"
+#include "eclass.h"
+#include "call.h"
+#include "filedetails.h"
+#include "idquery.h"
+#include "memstat.h"
+#include "projindex.h"
+
+vector <vector <const IdPropElem *> > ProjectIndex::project_ids;
+vector <vector <Call *> > ProjectIndex::project_functions;
+vector <vector <Fileid> > ProjectIndex::project_files;
+
+void
+ProjectIndex::build(const vector <Fileid> &files)
+{
+	Attributes::size_type n = Attributes::get_num_attributes();
+
+	project_ids.assign(n, vector <const IdPropElem *>());
+	for (const IdPropElem &i : Identifier::ids)
+		for (Attributes::size_type p = attr_end; p < n; p++)
+			if (i.first->get_attribute(p))
+				project_ids[p].push_back(&i);
+
+	// A function belongs to the projects of its name's EC
+	project_functions.assign(n, vector <Call *>());
+	for (Call::const_fmap_iterator_type i = Call::fbegin(); i != Call::fend(); i++) {
+		Eclass *ec = i->second->get_tokid().check_ec();
+		if (!ec)
+			continue;
+		for (Attributes::size_type p = attr_end; p < n; p++)
+			if (ec->get_attribute(p))
+				project_functions[p].push_back(i->second);
+	}
+
+	project_files.assign(n, vector <Fileid>());
+	for (Fileid f : files)
+		for (Attributes::size_type p = attr_end; p < n; p++)
+			if (Filedetails::get_attribute(f, p))
+				project_files[p].push_back(f);
+
+	// Release the unused capacity
+	for (auto &v : project_ids)
+		v.shrink_to_fit();
+	for (auto &v : project_functions)
+		v.shrink_to_fit();
+	for (auto &v : project_files)
+		v.shrink_to_fit();
+}
+
+void
+ProjectIndex::memory_stats(MemoryStats &s)
+{
+	size_t count = 0, bytes = 0;
+	for (const auto &v : project_ids) {
+		count += v.size();
+		bytes += vector_bytes(v);
+	}
+	for (const auto &v : project_functions) {
+		count += v.size();
+		bytes += vector_bytes(v);
+	}
+	for (const auto &v : project_files) {
+		count += v.size();
+		bytes += vector_bytes(v);
+	}
+	bytes += (project_ids.capacity() + project_functions.capacity() +
+	    project_files.capacity()) * sizeof(vector <Fileid>);
+	s.add("Project member lists", count, bytes);
+}
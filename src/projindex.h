@@ -0,0 +1,118 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Per-project lists of identifiers, functions, and files
+ *
+ */
+
+#ifndef PROJINDEX_
+#define PROJINDEX_
+
+#include <vector>
+
+using namespace std;
+
+#include "attr.h"
+#include "fileid.h"
+#include "call.h"
+#include "idquery.h"
+
+class MemoryStats;
+
+/*
+ * Lists of the identifiers, functions, and files belonging to each
+ * project, in the order in which their containers are traversed.
+ * Queries restricted to a project iterate over the project's lists,
+ * rather than testing the project attribute of every element.
+ * Until the lists are built, all elements are iterated.
+ */
+class ProjectIndex {
+	// Members of each project, by project attribute
+	static vector <vector <const IdPropElem *> > project_ids;
+	static vector <vector <Call *> > project_functions;
+	static vector <vector <Fileid> > project_files;
+
+	// Return the members of project p, or NULL for all elements
+	template <typename T>
+	static const vector <T> *members(const vector <vector <T> > &v,
+	    Attributes::size_type p) {
+		return p && p < v.size() ? &v[p] : NULL;
+	}
+public:
+	// Build the lists from the workspace's files, once the ECs are final
+	static void build(const vector <Fileid> &files);
+	// Add the memory used by the lists to s
+	static void memory_stats(MemoryStats &s);
+
+	/*
+	 * Iterate over the identifiers, functions, or files of
+	 * project p, or over all of them if p is 0, calling f
+	 * on each one until it returns false.
+	 * The workspace's files are passed in all.
+	 */
+	template <typename F>
+	static void for_each_identifier(Attributes::size_type p, F f) {
+		if (const vector <const IdPropElem *> *m = members(project_ids, p)) {
+			for (const IdPropElem *i : *m)
+				if (!f(*i))
+					return;
+		} else
+			for (const IdPropElem &i : Identifier::ids)
+				if (!f(i))
+					return;
+	}
+	template <typename F>
+	static void for_each_function(Attributes::size_type p, F f) {
+		if (const vector <Call *> *m = members(project_functions, p)) {
+			for (Call *c : *m)
+				if (!f(c))
+					return;
+		} else
+			for (Call::const_fmap_iterator_type i = Call::fbegin(); i != Call::fend(); i++)
+				if (!f(i->second))
+					return;
+	}
+	template <typename F>
+	static void for_each_file(Attributes::size_type p, const vector <Fileid> &all, F f) {
+		if (const vector <Fileid> *m = members(project_files, p)) {
+			for (Fileid fi : *m)
+				if (!f(fi))
+					return;
+		} else
+			for (Fileid fi : all)
+				if (!f(fi))
+					return;
+	}
+
+	// Return the number of elements iterated for project p
+	static size_t count_identifiers(Attributes::size_type p) {
+		const vector <const IdPropElem *> *m = members(project_ids, p);
+		return m ? m->size() : Identifier::ids.size();
+	}
+	static size_t count_functions(Attributes::size_type p) {
+		const vector <Call *> *m = members(project_functions, p);
+		return m ? m->size() : Call::functions().size();
+	}
+	static size_t count_files(Attributes::size_type p, const vector <Fileid> &all) {
+		const vector <Fileid> *m = members(project_files, p);
+		return m ? m->size() : all.size();
+	}
+};
+
+#endif // PROJINDEX_
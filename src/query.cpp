@@ -31,6 +31,7 @@
 #include <list>
 #include <set>
 #include <cctype>
+#include <algorithm>
 #include <sstream>		// ostringstream
 #include <cstdio>		// perror, rename
 #include <cstdlib>		// atoi
@@ -43,8 +44,19 @@
 #include "error.h"
 #include "parse.tab.h"
 #include "attr.h"
+#include "fileid.h"
 #include "compiledre.h"
 #include "query.h"
+#include "job.h"
+
+TrigramIndex <int> Query::file_index;
+
+void
+Query::build_file_index()
+{
+	for (const Fileid &f : Fileid::files(false))
+		file_index.add(f.get_id(), f.get_path());
+}
 
 // URL-encode the given string
 string
@@ -99,3 +111,51 @@ Query::equality_selection(FILE *of)
 		"</select>",
 		ec_ignore, ec_eq, ec_ne, ec_lt, ec_gt);
 }
+
+chrono::steady_clock::time_point QueryBudget::deadline;
+bool QueryBudget::timed;
+int QueryBudget::max_results;
+int QueryBudget::results;
+int QueryBudget::calls;
+bool QueryBudget::truncated;
+
+void
+QueryBudget::start()
+{
+	results = calls = 0;
+	truncated = false;
+	// Jobs exist for evaluating expensive queries
+	if (Job::is_job()) {
+		timed = false;
+		max_results = 0;
+		return;
+	}
+	int seconds = Option::query_time_limit->get();
+	timed = seconds > 0;
+	if (timed)
+		deadline = chrono::steady_clock::now() + chrono::seconds(seconds);
+	max_results = max(Option::query_result_limit->get(), 0);
+}
+
+string
+QueryBudget::truncation_message()
+{
+	if (max_results && results >= max_results)
+		return "Results truncated to " + to_string(max_results) +
+		    " entries by the query result limit";
+	return "Results truncated by the query time limit of " +
+	    to_string(Option::query_time_limit->get()) + "s";
+}
+
+void
+QueryBudget::html_marker(FILE *of)
+{
+	if (!truncated)
+		return;
+	fprintf(of, "<p class=\"truncated\"><b>%s.</b> "
+	    "The results shown are partial.  "
+	    "Run the query in the background or adjust the limits in the "
+	    "<a href=\"options.html\">options</a> "
+	    "to obtain all results.</p>\n",
+	    truncation_message().c_str());
+}
@@ -25,6 +25,8 @@
 #define QUERY_
 
 #include <iostream>
+#include <string>
+#include <chrono>
 
 using namespace std;
 
@@ -32,6 +34,7 @@ using namespace std;
 #include "option.h"
 #include "compiledre.h"
 #include "debug.h"
+#include "trigram.h"
 
 class Query {
 protected:
@@ -51,7 +54,22 @@ protected:
 	 * Errors are sent to of
 	 */
 	bool compile_re(FILE *of, const char *name, const char *varname, CompiledRE &re, bool &match,  string &str, int compflags = 0);
+	/*
+	 * Return true if the name of element key matches re.
+	 * Elements missing from the index candidates c cannot match,
+	 * and are rejected without executing the RE.
+	 */
+	template <typename K>
+	static bool re_match(const CompiledRE &re,
+	    const typename TrigramIndex<K>::Candidates &c, K key,
+	    const string &name) {
+		return TrigramIndex<K>::may_match(c, key) && re.exec(name) == 0;
+	}
+	// Index of file paths, by file id
+	static TrigramIndex <int> file_index;
 public:
+	// Build the index of file paths
+	static void build_file_index();
 	// Comparisson constants used for selections
 	enum e_cmp {
 		ec_ignore,
@@ -121,4 +139,46 @@ Query::apply(int op, double a, double b)
 	}
 }
 
+/*
+ * The time and result-count budget of the query evaluated by a
+ * page, as set through the query_time_limit and query_result_limit
+ * options.  Evaluation loops check exhausted() cooperatively,
+ * stop when it returns true, and count their results through
+ * add_result(); the page then displays the partial results
+ * with a truncation marker.
+ * A budget is unlimited until start() is called, and background
+ * jobs run without one.
+ */
+class QueryBudget {
+	static chrono::steady_clock::time_point deadline;
+	static bool timed;		// True if the deadline applies
+	static int max_results;		// Zero for no limit
+	static int results;
+	static int calls;		// For sampling the clock
+	static bool truncated;
+public:
+	// Start the budget of a new page's evaluation
+	static void start();
+	// Count n results found
+	static void add_result(int n = 1) { results += n; }
+	// Return true if the evaluation must stop
+	static bool exhausted() {
+		if (truncated)
+			return true;
+		if (max_results && results >= max_results)
+			return truncated = true;
+		// Reading the clock is comparatively expensive
+		if (timed && (++calls & 63) == 0 &&
+		    chrono::steady_clock::now() >= deadline)
+			return truncated = true;
+		return false;
+	}
+	// True if an evaluation was stopped due to the budget
+	static bool is_truncated() { return truncated; }
+	// Return a plain-text description of the exhausted budget
+	static string truncation_message();
+	// Output an HTML truncation marker, if the results were truncated
+	static void html_marker(FILE *of);
+};
+
 #endif // QUERY_
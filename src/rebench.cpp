@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Regular expression matching microbenchmark
+ * Matches each RE specified as an argument against all lines read
+ * from the standard input (e.g. identifier names or file paths),
+ * using regexec and CompiledRE, and reports the time each took.
+ *
+ * Usage: rebench [-i] RE ... <corpus
+ *
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <regex.h>
+
+#include "compiledre.h"
+
+using namespace std;
+
+// Return the elapsed time in ms for calling f rounds times
+template <typename F>
+static double
+time_ms(int rounds, F f)
+{
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++)
+		f();
+	chrono::duration<double, milli> d(chrono::steady_clock::now() - start);
+	return d.count();
+}
+
+int
+main(int argc, char *argv[])
+{
+	int flags = REG_EXTENDED | REG_NOSUB;
+	int argi = 1;
+	if (argi < argc && strcmp(argv[argi], "-i") == 0) {
+		flags |= REG_ICASE;
+		argi++;
+	}
+	if (argi == argc) {
+		cerr << "Usage: " << argv[0] << " [-i] RE ... <corpus" << endl;
+		exit(1);
+	}
+
+	vector <string> corpus;
+	string line;
+	while (getline(cin, line))
+		corpus.push_back(line);
+	if (corpus.empty()) {
+		cerr << "Empty corpus" << endl;
+		exit(1);
+	}
+	// Repeat the matching over at least one million strings
+	int rounds = 1000000 / corpus.size() + 1;
+
+	for (; argi < argc; argi++) {
+		regex_t re;
+		if (regcomp(&re, argv[argi], flags) != 0) {
+			cerr << "Bad RE " << argv[argi] << endl;
+			exit(1);
+		}
+		CompiledRE cre(argv[argi], flags);
+
+		int nraw = 0, ncre = 0;
+		double traw = time_ms(rounds, [&]() {
+			nraw = 0;
+			for (const string &s : corpus)
+				if (regexec(&re, s.c_str(), 0, NULL, 0) == 0)
+					nraw++;
+		});
+		double tcre = time_ms(rounds, [&]() {
+			ncre = 0;
+			for (const string &s : corpus)
+				if (cre.exec(s) == 0)
+					ncre++;
+		});
+		regfree(&re);
+
+		cout << argv[argi] << '\t' << nraw << " matches\tregexec " <<
+		    traw << " ms\tCompiledRE " << tcre << " ms" << endl;
+		if (nraw != ncre) {
+			cerr << "Match count mismatch: regexec " << nraw <<
+			    " CompiledRE " << ncre << endl;
+			exit(1);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Regular expression matching test
+ * Reads lines containing an extended RE and a string separated by
+ * a tab, and matches the string against the RE, with and without
+ * case sensitivity, using regexec and CompiledRE.
+ * For each line it outputs the RE, the string, and Y or N for
+ * each of the two matches.  Matches in which CompiledRE differs
+ * from regexec are marked and cause a non-zero exit status.
+ *
+ * Usage: retest <cases
+ *
+ */
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include <regex.h>
+
+#include "compiledre.h"
+
+using namespace std;
+
+/*
+ * Match str against re compiled with flags and output the result.
+ * Return false if CompiledRE and regexec differ.
+ */
+static bool
+match(const string &re, const string &str, int flags)
+{
+	regex_t raw;
+	if (regcomp(&raw, re.c_str(), flags) != 0) {
+		cerr << "Bad RE " << re << endl;
+		exit(1);
+	}
+	CompiledRE cre(re.c_str(), flags);
+
+	bool mraw = regexec(&raw, str.c_str(), 0, NULL, 0) == 0;
+	bool mcre = cre.exec(str) == 0;
+	regfree(&raw);
+
+	cout << '\t' << (mraw ? 'Y' : 'N');
+	if (mraw != mcre)
+		cout << " (CompiledRE " << (mcre ? 'Y' : 'N') << ')';
+	return mraw == mcre;
+}
+
+int
+main(int argc, char *argv[])
+{
+	if (argc != 1) {
+		cerr << "Usage: " << argv[0] << " <cases" << endl;
+		exit(1);
+	}
+
+	bool ok = true;
+	string line;
+	while (getline(cin, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		string::size_type tab = line.find('\t');
+		if (tab == string::npos) {
+			cerr << "Missing tab: " << line << endl;
+			exit(1);
+		}
+		string re(line, 0, tab);
+		string str(line, tab + 1);
+
+		cout << re << '\t' << str;
+		ok = match(re, str, REG_EXTENDED | REG_NOSUB) && ok;
+		ok = match(re, str, REG_EXTENDED | REG_NOSUB | REG_ICASE) && ok;
+		cout << endl;
+	}
+	return ok ? 0 : 1;
+}
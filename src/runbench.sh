@@ -0,0 +1,63 @@
+#!/bin/sh
+#
+# (C) Copyright 2026 Diomidis Spinellis
+#
+# This file is part of CScout.
+#
+# CScout is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# CScout is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+#
+#
+# Run CScout on a synthetic workspace in its batch processing modes
+# and report the time and memory each mode required.
+# The arguments are passed to genbench.pl to shape the workspace.
+# Per-phase profiling reports of each mode are left in
+# build/bench/profile-MODE.csv.
+#
+
+set -e
+
+SRCDIR=$(cd $(dirname $0) ; pwd)
+CSCOUT=$SRCDIR/build/cscout
+BENCH=$SRCDIR/build/bench
+
+rm -rf $BENCH
+perl $SRCDIR/genbench.pl "$@" $BENCH
+cd $BENCH
+echo "Workspace: $(ls u*.c | wc -l) CUs, $(cat u*.c include/*.h | wc -l) lines"
+
+# Run cscout in the specified mode with the remaining arguments
+# and report the profile's total row
+run()
+{
+	MODE=$1
+	shift
+	if ! $CSCOUT -q -T csv:profile-$MODE.csv "$@" bench.cs \
+	    >out-$MODE.txt 2>err-$MODE.txt ; then
+		echo "$MODE: cscout failed; see $BENCH/err-$MODE.txt" 1>&2
+		exit 1
+	fi
+	awk -F, -v mode=$MODE '$1 == "total" {
+		printf "%-12s %10.2f %10.2f %10.2f %12d\n", mode, $3, $4, $5, $6
+	}' profile-$MODE.csv
+}
+
+printf "%-12s %10s %10s %10s %12s\n" Mode Wall User System "Peak RSS KB"
+run compile -c
+run report -r
+if $CSCOUT 2>&1 | grep -q sqlite:FILE ; then
+	run sqlite -s sqlite:bench.db
+else
+	run sqlite -s sqlite
+fi
+run callgraph -R 'cgraph.txt?all=1' -R 'fgraph.txt?gtype=F&n=D'
@@ -27,6 +27,8 @@
 # -TEST_OBFUSCATION
 # -TEST_SQL
 # -TEST_PERL
+# -TEST_WEB
+# -TEST_RE
 #
 # To run a single test set the corresponding environment variable e.g.
 # CFILES=c36-endlabel.c ./runtest.sh -TEST_C
@@ -34,6 +36,8 @@
 # CPPFILES=cpp63-rescan.c ./runtest.sh -TEST_CPP
 # SQLFILES=sql08-common-ids.sql ./runtest.sh -TEST_SQL
 #
+# The web server tests listen on port 8089; set WEB_PORT to change it.
+#
 
 export LC_ALL=C
 
@@ -358,6 +362,207 @@ runtest_cpp()
 	end_compare $DIR $NAME
 }
 
+# Convert the output of the bulk-load back-ends into SQLite commands,
+# so that it can be checked with the SQLite tests
+bulk_to_sqlite()
+{
+  perl -e '
+    my %esc = ("\\" => "\\", "t" => "\t", "n" => "\n", "r" => "\r");
+    my (%bool, $table, $ncol);
+
+    # Output as INSERT statements the rows of table t read from in
+    sub load {
+      my ($t, $in) = @_;
+      while (<$in>) {
+        chomp;
+        last if $_ eq "\\.";
+        my @f = split(/\t/, $_, -1);
+        for my $i (0 .. $#f) {
+          if ($f[$i] eq "\\N") {
+            $f[$i] = "NULL";
+          } elsif (!$bool{$t}{$i}) {
+            $f[$i] =~ s/\\(.)/$esc{$1}/g;
+            $f[$i] =~ s/\x27/\x27\x27/g;
+            $f[$i] = "\x27$f[$i]\x27";
+          }
+        }
+        print "INSERT INTO $t VALUES(", join(",", @f), ");\n";
+      }
+    }
+
+    while (<STDIN>) {
+      # Note the Boolean columns, whose values are not quoted
+      if (/^CREATE TABLE (\w+)\(/) {
+        $table = $1;
+        $ncol = 0;
+      } elsif (defined($table) && /^\)/) {
+        undef $table;
+      } elsif (defined($table) && /^\s+\w+ (\w+)/) {
+        $bool{$table}{$ncol} = 1 if ($1 =~ /^bool/i);
+        $ncol++;
+      }
+      if (/^COPY (\w+) FROM STDIN;/) {
+        load($1, \*STDIN);
+      } elsif (/^LOAD DATA LOCAL INFILE \x27(.*)\x27 INTO TABLE (\w+);/) {
+        open(my $in, "<", $1) || die "$1: $!\n";
+        load($2, $in);
+      } elsif (/^ALTER TABLE (\w+) ADD PRIMARY KEY\((.*)\);/) {
+        print "CREATE UNIQUE INDEX PK_$1 ON $1($2);\n";
+      } elsif (!/^SET /) {
+        print;
+      }
+    }
+  '
+}
+
+# Test that the files can be reconstituted from the text stored in the database
+# runtest_text name database
+runtest_text()
+{
+  NAME=$1
+  DB=$2
+  start_test . $NAME
+  mkdir -p test/err/text
+  sqlite3 $DB "SELECT fid, name FROM files WHERE fid != 1" |
+  while IFS='|' read fid name
+  do
+    sqlite3 $DB "SELECT group_concat(s, '') FROM (
+      SELECT s FROM (
+        SELECT name AS s, foffset FROM ids
+          INNER JOIN tokens ON ids.eid = tokens.eid WHERE fid = $fid
+        UNION ALL SELECT code, foffset FROM rest WHERE fid = $fid
+        UNION ALL SELECT comment, foffset FROM comments WHERE fid = $fid
+        UNION ALL SELECT string, foffset FROM strings WHERE fid = $fid)
+      ORDER BY foffset)" >test/err/text/$fid
+    # The query's output ends with a newline
+    { cat "$name" ; echo ; } | cmp -s - test/err/text/$fid || echo "$name"
+  done >test/err/text/$NAME
+  if [ -s test/err/text/$NAME ]
+  then
+    end_test $NAME 0
+    show_error test/err/text/$NAME
+  else
+    end_test $NAME 1
+  fi
+}
+
+# Test the order and size of the INSERT statements output for the awk example
+# Rows of different tables are interleaved, and whenever the batch of a table
+# fills up, the rows of all tables are output in the order of their first row.
+# runtest_sql_order name
+runtest_sql_order()
+{
+  NAME=$1
+  start_test . $NAME
+  (cd ../example ; ../src/$CSCOUT -s sqlite awk.cs 2>/dev/null) |
+  perl -ne '
+    if (/^INSERT INTO (\w+) /) {
+      $table = $1;
+      $nrows = 1;
+    } elsif (defined($table) && /^\(/) {
+      $nrows++;
+    } elsif (/^[A-Z]/) {
+      print;
+    }
+    if (defined($table) && /\);$/) {
+      print "INSERT INTO $table: $nrows rows\n";
+      undef $table;
+    }
+  ' >test/nout/$NAME
+  end_compare . $NAME
+}
+
+# Output the page at the specified URL of the CScout web server
+# Pass a second argument to request and decompress gzip content encoding
+web_get()
+{
+  perl -MHTTP::Tiny -MIO::Uncompress::Gunzip=gunzip,\$GunzipError -e '
+    my ($url, $gzip) = @ARGV;
+    my %headers;
+    $headers{"Accept-Encoding"} = "gzip" if ($gzip);
+    my $r = HTTP::Tiny->new->get($url, { headers => \%headers });
+    die "$url: $r->{status} $r->{reason}\n" unless ($r->{success});
+    my $content = $r->{content};
+    if (($r->{headers}{"content-encoding"} // "") eq "gzip") {
+      my $plain;
+      gunzip(\$content => \$plain) || die "$url: $GunzipError\n";
+      $content = $plain;
+    }
+    print $content;
+  ' "http://localhost:$WEB_PORT/$1" $2
+}
+
+# Test a page of the CScout web server
+# runtest_web name url [gzip]
+runtest_web()
+{
+	NAME=$1
+	start_test web $NAME
+	# Keep the page's body, without the version-dependent footer
+	# and timing, and number the element addresses in their order
+	# of appearance
+	web_get "$2" $3 2>test/err/web/$NAME.err |
+	sed -n -e "s|$(pwd)/||g" -e '/class="footer"/d' -e 's/^[0-9.]*ms CPU time<br \/>//' -e '/^<body>/,$p' |
+	perl -pe 's/0x[0-9a-f]+/$addr{$&} \/\/= "p" . ++$n/ge' >test/nout/$NAME
+	end_compare . $NAME
+}
+
+# Test a plain text page of the CScout web server
+# runtest_web_txt name url
+runtest_web_txt()
+{
+	NAME=$1
+	start_test web $NAME
+	web_get "$2" 2>test/err/web/$NAME.err >test/nout/$NAME
+	end_compare . $NAME
+}
+
+# Wait for up to 30s for the specified background job to finish
+web_job_wait()
+{
+	for i in $(seq 30)
+	do
+		web_get "job.txt?id=$1" | grep -q '^running' || break
+		sleep 1
+	done
+}
+
+# Parse the JSON text read from the standard input, which must be valid
+# UTF-8, and output it in a canonical form: with sorted object keys and
+# array elements, non-ASCII characters escaped, and addresses elided
+json_canon()
+{
+  perl -MJSON::PP -e '
+    my $json = JSON::PP->new->utf8->ascii->canonical->pretty;
+    sub canon {
+      my ($v) = @_;
+      if (ref($v) eq "HASH") {
+        $v->{$_} = canon($v->{$_}) for (keys %$v);
+      } elsif (ref($v) eq "ARRAY") {
+        @$v = sort { $json->encode($a) cmp $json->encode($b) } map { canon($_) } @$v;
+      } elsif (defined($v) && !ref($v) && $v =~ m/^0x[0-9a-f]+$/) {
+        $v = "ADDR";
+      }
+      return $v;
+    }
+    local $/;
+    my $v = eval { $json->decode(<STDIN>) };
+    print defined($v) ? $json->encode(canon($v)) : "Invalid JSON: $@";
+  '
+}
+
+# Test a JSON page of the CScout web server
+# runtest_web_json name url
+runtest_web_json()
+{
+	NAME=$1
+	start_test web $NAME
+	web_get "$2" 2>test/err/web/$NAME.err |
+	sed -e "s|$(pwd)/||g" -e "s|$(cd .. ; /bin/pwd)/||g" |
+	json_canon >test/nout/$NAME
+	end_compare . $NAME
+}
+
 # Test the exection of supplied SQL scripts
 # runtest name directory source-path csfile
 runtest_sql()
@@ -370,7 +575,7 @@ runtest_sql()
   mkdir -p test/err/chunk
   (
     sql_output
-    cat test/sql/$NAME
+    sed "$SQL_FILTER" test/sql/$NAME
   ) |
   sqlite3 $DB >test/nout/$NAME.out 2>test/nout/$NAME.err
   end_compare $DIR $NAME
@@ -408,6 +613,8 @@ set_test()
 	TEST_OBFUSCATION=$1
 	TEST_SQL=$1
 	TEST_PERL=$1
+	TEST_WEB=$1
+	TEST_RE=$1
 }
 
 #
@@ -531,6 +738,190 @@ then
     runtest_sql $i ../example $DB
   done
   rm -f $DB
+
+  runtest_sql_order sql-order
+
+  # Repeat the queries on a database written directly by CScout,
+  # with normal and compact TOKENS and LINEPOS tables
+  if $CSCOUT 2>&1 | grep -q sqlite:FILE
+  then
+    for mode in native compact
+    do
+      TEST_GROUP="SQL $mode"
+      if [ $mode = compact ]
+      then
+        COMPACT=-z
+        # TOKENS is then a view, which cannot be indexed
+        SQL_FILTER='/^CREATE INDEX .* [Oo][Nn] tokens(/d'
+      else
+        COMPACT=
+        SQL_FILTER=
+      fi
+      (
+        cd ../example
+        ../src/$CSCOUT $COMPACT -s sqlite:../src/$DB awk.cs 2>../src/test/err/chunk/sql-$mode.cs
+      )
+      (
+        echo "UPDATE files SET name = SUBSTR(name, INSTR(name, '/example/') + 1);"
+        echo "UPDATE files SET name = SUBSTR(name, INSTR(name, '/../../') + 7) WHERE name LIKE '%/../../%';"
+      ) |
+      sqlite3 $DB >/dev/null 2>test/err/chunk/sql-$mode.sqlite
+
+      for i in $SQLFILES
+      do
+        runtest_sql $i ../example $DB
+      done
+      rm -f $DB
+    done
+  fi
+
+  # Repeat the queries on databases loaded from the output of the
+  # bulk-load back-ends, after checking the escaping of its text
+  SQL_FILTER=
+  mkdir -p test/err/bulk
+  for engine in postgres-copy mysql-load:$(pwd)/test/err/bulk
+  do
+    dialect=${engine%%:*}
+    TEST_GROUP="SQL $dialect"
+    rm -f $DB test/err/bulk/*
+    (
+      cd ../example
+      sql_prologue
+      ../src/$CSCOUT -s $engine awk.cs 2>../src/test/err/chunk/sql-$dialect.cs |
+      bulk_to_sqlite
+    ) |
+    sqlite3 $DB >/dev/null 2>test/err/chunk/sql-$dialect.sqlite
+    runtest_text $dialect-text $DB
+    (
+      echo "UPDATE files SET name = SUBSTR(name, INSTR(name, '/example/') + 1);"
+      echo "UPDATE files SET name = SUBSTR(name, INSTR(name, '/../../') + 7) WHERE name LIKE '%/../../%';"
+    ) |
+    sqlite3 $DB >/dev/null 2>>test/err/chunk/sql-$dialect.sqlite
+
+    for i in $SQLFILES
+    do
+      runtest_sql $i ../example $DB
+    done
+    rm -f $DB
+  done
+fi
+
+# Web server pages
+if [ $TEST_WEB = 1 ]
+then
+  TEST_GROUP=web
+  WEB_PORT=${WEB_PORT:-8089}
+  # Work on a copy of the source, which is modified by a hand edit
+  rm -rf test/err/web
+  mkdir -p test/err/web
+  cp test/web/*.c test/err/web/
+  chmod u+w test/err/web/*.c
+  echo "
+workspace WebWS {
+	directory test/err/web {
+	project Web {
+		file src.c
+	}
+	project $(printf 'Caf\351') {
+		file json.c
+	}
+	project $(printf 'Caf\303\251') {
+		file json.c
+	}
+	}
+}
+" |
+  perl cswc.pl -d $DOTCSCOUT >test/err/web/web.cs 2>/dev/null
+  $CSCOUT -p $WEB_PORT test/err/web/web.cs >test/err/web/server.out 2>&1 &
+  WEB_PID=$!
+  for i in 1 2 3 4 5 6 7 8 9 10
+  do
+    web_get index.html >/dev/null 2>&1 && break
+    sleep 1
+  done
+
+  # Id of src.c and query arguments marking all identifiers and functions
+  FID=4
+  IDQ="qt=id&id=$FID&match=Y&writable=1&a9=1&n=Identifiers"
+  FUNQ="qt=fun&id=$FID&match=Y&writable=1&ro=1&n=Functions"
+  # Options set through the options page; unspecified Boolean ones are cleared
+  TEXT_OPTIONS="dot_graph_options=&dot_node_options=&dot_edge_options=&sfile_re_string=&sfile_repl_string="
+
+  runtest_web web-src "src.html?id=$FID"
+  runtest_web web-src-gzip "src.html?id=$FID" gzip
+  runtest_web web-src-marku "src.html?id=$FID&marku=1"
+  runtest_web web-qsrc-id "qsrc.html?$IDQ"
+  runtest_web web-qsrc-ire "qsrc.html?$IDQ&ire=^split"
+  runtest_web web-qsrc-fun "qsrc.html?$FUNQ"
+  runtest_web web-qsrc-fre "qsrc.html?$FUNQ&fnre=^count"
+
+  runtest_web_json web-json-xiquery "xiquery.json?match=Y&writable=1&a9=1&ire=^(leaf|middle|top)\$"
+  runtest_web_json web-json-xiquery-qfun "xiquery.json?match=Y&writable=1&a9=1&ire=^(leaf|middle|top)\$&qfun=1"
+  runtest_web_json web-json-xiquery-error "xiquery.json?writable=1"
+  FUN=$(web_get "xfunquery.json?match=Y&writable=1&ro=1&fnre=^middle\$" |
+    perl -MJSON::PP -e 'local $/; print decode_json(<STDIN>)->{functions}[0]{id}')
+  runtest_web_json web-json-fun "fun.json?f=$FUN"
+  runtest_web_json web-json-fun-error "fun.json"
+  runtest_web_json web-json-fgraph "fgraph.json?gtype=I&all=1"
+  runtest_web_json web-json-fgraph-error "fgraph.json?gtype=X"
+  runtest_web_json web-json-file "file.json?id=5"
+
+  web_get "soptions.html?set=Apply&show_line_number=1&$TEXT_OPTIONS&start_editor_cmd=" >/dev/null
+  runtest_web web-src-lines "src.html?id=$FID"
+  runtest_web web-src-lines-marku "src.html?id=$FID&marku=1"
+  runtest_web web-qsrc-id-lines "qsrc.html?$IDQ"
+
+  # The hand edit appends a line to the file; the page shows the original
+  web_get "soptions.html?set=Apply&$TEXT_OPTIONS&start_editor_cmd=echo+%25s+%3E/dev/null%3B+echo+%27int+edited%3B%27+%3E%3E%25s" >/dev/null
+  web_get "fedit.html?id=$FID" >/dev/null
+  runtest_web web-src-edited "src.html?id=$FID"
+  runtest_web web-qsrc-id-edited "qsrc.html?$IDQ"
+
+  # Results beyond the query's limit are reported as truncated
+  web_get "soptions.html?set=Apply&query_result_limit=1&$TEXT_OPTIONS&start_editor_cmd=" >/dev/null
+  runtest_web_json web-json-xiquery-truncated "xiquery.json?match=Y&writable=1&a9=1&ire=^(leaf|middle)\$&qf=1"
+  runtest_web_json web-json-fgraph-truncated "fgraph.json?gtype=I&all=1"
+
+  # Queries evaluated as background jobs, which are not truncated
+  runtest_web web-job-start "xiquery.html?match=Y&writable=1&a9=1&ire=^(leaf|middle)\$&qi=1&n=Leaves&bg=1"
+  web_job_wait 1
+  runtest_web_txt web-job-status "job.txt?id=1"
+  runtest_web web-job-result "job.html?id=1"
+  # The back-references make regexec take minutes on each file path
+  SLOW_RE='(.*)(.*)(.*)(.*)(.*)(.*)(.*)(.*)%5C8%5C7%5C6%5C5%5C4%5C3%5C2%5C1'
+  web_get "xfilequery.html?match=Y&writable=1&fre=$SLOW_RE&n=Slow&bg=1" >/dev/null
+  runtest_web_txt web-job-running "job.txt?id=2"
+  runtest_web web-job-list "jobs.html"
+  runtest_web web-job-cancel "job.html?id=2&cancel=1"
+  runtest_web_txt web-job-cancelled "job.txt?id=2"
+  runtest_web web-job-remove "job.html?id=1&remove=1"
+  runtest_web_txt web-job-removed "job.txt?id=1"
+  # The output files are removed once the server no longer has them open
+  web_get "job.html?id=2&remove=1" >/dev/null
+  start_test web web-job-files
+  ls -l /proc/$WEB_PID/fd 2>test/err/web/web-job-files.err |
+  grep -c cscout-job- >test/nout/web-job-files
+  end_compare . web-job-files
+
+  web_get qexit.html >/dev/null || kill $WEB_PID
+  wait $WEB_PID
+fi
+
+# Regular expression matching through CompiledRE and regexec
+if [ $TEST_RE = 1 ]
+then
+	TEST_GROUP="regular expression"
+	mkdir -p test/err/re
+	start_test re retest
+	$(dirname $0)/build/retest <test/re/cases >test/nout/retest 2>test/err/re/retest.err
+	if [ $? = 0 ]
+	then
+		end_compare . retest
+	else
+		end_test retest 0
+		grep CompiledRE test/nout/retest >>test/err/re/retest.err
+		show_error test/err/re/retest.err
+	fi
 fi
 
 # Perl scripts
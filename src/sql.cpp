@@ -21,8 +21,16 @@
  *
  */
 
+#include <cmath>
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
+#include <fstream>
+#include <string>
+
+#ifdef HAVE_SQLITE
+#include <sqlite3.h>
+#endif
 
 #include "cpp.h"
 #include "sql.h"
@@ -74,20 +82,202 @@ Sqlite::escape(char c)
 	}
 }
 
+/*
+ * Append to out the string s escaped for use in an SQL string.
+ * Runs of characters that need no escaping are copied in bulk.
+ */
+void
+Sql::append_escaped(string &out, const string &s)
+{
+	const char *specials = special_chars();
+	bool single = specials[1] == 0;
+
+	for (string::size_type pos = 0;;) {
+		// With a single special character find uses memchr
+		string::size_type next = single ?
+			s.find(specials[0], pos) : s.find_first_of(specials, pos);
+		if (next == string::npos) {
+			out.append(s, pos, string::npos);
+			return;
+		}
+		out.append(s, pos, next - pos);
+		out += escape(s[next]);
+		pos = next + 1;
+	}
+}
+
+// Start inserting a row into the specified table
+void
+Sql::begin_row(ostream &, const char *table)
+{
+	if (!current || current->table != table) {
+		auto ti = table_index.find(table);
+		if (ti == table_index.end()) {
+			ti = table_index.emplace(table, tables.size()).first;
+			tables.emplace_back(table);
+		}
+		current = &tables[ti->second];
+	}
+	buffered -= current->data.length();
+	open_row(*current);
+	first_value = true;
+}
+
+void
+Sql::real_value(ostream &of, double v)
+{
+	// Integral values are output exactly, rather than in %g format
+	if (fabs(v) < 1e18 && v == (long long)v) {
+		int_value(of, (long long)v);
+		return;
+	}
+	char buff[32];
+	separate();
+	current->data.append(buff, snprintf(buff, sizeof(buff), real_format, v));
+}
+
+// Finish the row started with begin_row
+void
+Sql::end_row(ostream &of)
+{
+	close_row(*current);
+	current->nrows++;
+	buffered += current->data.length();
+	if (current->nrows == max_batch_rows || buffered > max_buffered)
+		flush(of);
+}
+
+/*
+ * Output all buffered rows.
+ * The tables are output in the order of their first row, so that
+ * rows referenced by foreign keys are always output first.
+ */
+void
+Sql::flush(ostream &of)
+{
+	for (auto &t : tables)
+		if (t.nrows) {
+			output_rows(of, t);
+			t.data.clear();
+			t.nrows = 0;
+		}
+	buffered = 0;
+}
+
+// Return the command to create a deferred primary key
+string
+Sql::add_primary_key(const string &table, const string &columns)
+{
+	return "ALTER TABLE " + table + " ADD PRIMARY KEY(" + columns + ");\n";
+}
+
+/*
+ * SQLite cannot add a primary key to an existing table.
+ * A unique index provides the same integrity check and access path.
+ */
 string
-Sql::escape(string s)
+Sqlite::add_primary_key(const string &table, const string &columns)
 {
-	string r;
+	return "CREATE UNIQUE INDEX PK_" + table + " ON " + table +
+		"(" + columns + ");\n";
+}
 
-	for (string::const_iterator i = s.begin(); i != s.end(); i++)
-		r += escape(*i);
-	return r;
+/*
+ * The compact token blocks hold for each file a JSON array of
+ * interleaved offset and identifier key differences from the previous
+ * token; the line blocks hold the differences between successive line
+ * offsets.  The views rebuild the absolute values through running sums.
+ */
+const char *
+Sqlite::tokens_view()
+{
+	return
+		"CREATE VIEW TOKENS AS\n"
+		"  SELECT FID, FOFFSET, EID FROM (\n"
+		"    SELECT FID, key,\n"
+		"      SUM(CASE key % 2 WHEN 0 THEN value ELSE 0 END) OVER w AS FOFFSET,\n"
+		"      SUM(CASE key % 2 WHEN 1 THEN value ELSE 0 END) OVER w AS EID\n"
+		"    FROM TOKENBLOCKS, json_each(TOKENBLOCKS.TOKENS)\n"
+		"    WINDOW w AS (PARTITION BY FID ORDER BY key))\n"
+		"  WHERE key % 2 = 1;\n";
+}
+
+const char *
+Sqlite::linepos_view()
+{
+	return
+		"CREATE VIEW LINEPOS AS\n"
+		"  SELECT FID, SUM(value) OVER (PARTITION BY FID ORDER BY key) AS FOFFSET,\n"
+		"    key + 1 AS LNUM\n"
+		"  FROM LINEBLOCKS, json_each(LINEBLOCKS.FOFFSETS);\n";
+}
+
+const char *
+Postgres::tokens_view()
+{
+	return
+		"CREATE VIEW TOKENS AS\n"
+		"  SELECT FID, FOFFSET, EID FROM (\n"
+		"    SELECT FID, N,\n"
+		"      (SUM(CASE N % 2 WHEN 1 THEN V::BIGINT ELSE 0 END) OVER w)::INTEGER AS FOFFSET,\n"
+		"      (SUM(CASE N % 2 WHEN 0 THEN V::BIGINT ELSE 0 END) OVER w)::BIGINT AS EID\n"
+		"    FROM TOKENBLOCKS,\n"
+		"      json_array_elements_text(TOKENBLOCKS.TOKENS::JSON) WITH ORDINALITY AS E(V, N)\n"
+		"    WINDOW w AS (PARTITION BY FID ORDER BY N)) AS T\n"
+		"  WHERE N % 2 = 0;\n";
+}
+
+const char *
+Postgres::linepos_view()
+{
+	return
+		"CREATE VIEW LINEPOS AS\n"
+		"  SELECT FID, (SUM(V::INTEGER) OVER (PARTITION BY FID ORDER BY N))::INTEGER AS FOFFSET,\n"
+		"    N::INTEGER AS LNUM\n"
+		"  FROM LINEBLOCKS,\n"
+		"    json_array_elements_text(LINEBLOCKS.FOFFSETS::JSON) WITH ORDINALITY AS E(V, N);\n";
+}
+
+const char *
+Mysql::tokens_view()
+{
+	return
+		"CREATE VIEW TOKENS AS\n"
+		"  SELECT FID, FOFFSET, EID FROM (\n"
+		"    SELECT FID, N,\n"
+		"      SUM(IF(N % 2 = 1, V, 0)) OVER w AS FOFFSET,\n"
+		"      SUM(IF(N % 2 = 0, V, 0)) OVER w AS EID\n"
+		"    FROM TOKENBLOCKS, JSON_TABLE(TOKENBLOCKS.TOKENS, '$[*]'\n"
+		"      COLUMNS(N FOR ORDINALITY, V BIGINT PATH '$')) AS E\n"
+		"    WINDOW w AS (PARTITION BY FID ORDER BY N)) AS T\n"
+		"  WHERE N % 2 = 0;\n";
+}
+
+const char *
+Mysql::linepos_view()
+{
+	return
+		"CREATE VIEW LINEPOS AS\n"
+		"  SELECT FID, SUM(V) OVER (PARTITION BY FID ORDER BY N) AS FOFFSET,\n"
+		"    N AS LNUM\n"
+		"  FROM LINEBLOCKS, JSON_TABLE(LINEBLOCKS.FOFFSETS, '$[*]'\n"
+		"    COLUMNS(N FOR ORDINALITY, V INTEGER PATH '$')) AS E;\n";
 }
 
 bool
 Sql::setEngine(string_view dbengine)
 {
-	if (dbengine =="mysql")
+#ifdef HAVE_SQLITE
+	if (dbengine.substr(0, 7) == "sqlite:") {
+		instance = new SqliteNative(string(dbengine.substr(7)));
+		return true;
+	}
+#endif
+	if (dbengine.substr(0, 11) == "mysql-load:")
+		instance = new MysqlLoad(string(dbengine.substr(11)));
+	else if (dbengine == "postgres-copy")
+		instance = new PostgresCopy();
+	else if (dbengine =="mysql")
 		instance = new Mysql();
 	else if (dbengine =="hsqldb")
 		instance = new Hsqldb();
@@ -97,12 +287,48 @@ Sql::setEngine(string_view dbengine)
 		instance = new Sqlite();
 	else {
 		cerr << "Unknown database engine " << dbengine << "\n";
-		cerr << "Supported database engine types are: hsqldb mysql postgres sqlite\n";
+		cerr << "Supported database engine types are: hsqldb mysql postgres sqlite"
+			" mysql-load:DIR postgres-copy"
+#ifdef HAVE_SQLITE
+			" sqlite:FILE"
+#endif
+			"\n";
 		return false;
 	}
 	return true;
 }
 
+/*
+ * Integrity checks are not needed while loading the data.
+ * Keys are added after the data are loaded, and
+ * the generated data are consistent.
+ * The session's SQL mode is restored by end_commands.
+ */
+const char *
+MysqlLoad::begin_commands()
+{
+	return "SET @old_sql_mode=@@sql_mode;\n"
+		"SET SESSION sql_mode=NO_BACKSLASH_ESCAPES;\n"
+		"SET unique_checks = 0;\n"
+		"SET foreign_key_checks = 0;\n";
+}
+
+// Write the table's rows into a file and output the command to load it
+void
+MysqlLoad::output_rows(ostream &of, const TableRows &t)
+{
+	string path(directory + '/' + t.table + '-' + to_string(nfiles++) + ".tsv");
+	ofstream out(path.c_str(), ios::binary);
+	out.write(t.data.data(), t.data.length());
+	if (!out.good()) {
+		perror(path.c_str());
+		exit(1);
+	}
+	// The default field and line specifications match our format
+	of << "LOAD DATA LOCAL INFILE '" << escape(path) <<
+		"' INTO TABLE " << t.table << ";\n";
+}
+
 /*
  * Implement very fast database inserts at the risk of
  * possible data corruption in case of a crash.
@@ -124,3 +350,158 @@ Sqlite::begin_commands()
 		"PRAGMA locking_mode = EXCLUSIVE;\n\n";
 
 };
+
+#ifdef HAVE_SQLITE
+SqliteNative::SqliteNative(const string &p) : db(nullptr), path(p), nvalues(0)
+{
+	check(sqlite3_open_v2(path.c_str(), &db,
+	    SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr),
+	    SQLITE_OK, "open");
+}
+
+SqliteNative::~SqliteNative()
+{
+	for (auto &s : statements)
+		sqlite3_finalize(s.second);
+	if (sqlite3_close(db) != SQLITE_OK)
+		cerr << path << ": " << sqlite3_errmsg(db) << endl;
+}
+
+// Exit with an error message if rc is not the expected code
+void
+SqliteNative::check(int rc, int expected, const char *context)
+{
+	if (rc == expected)
+		return;
+	cerr << path << ": " << context << ": ";
+	if (db)
+		cerr << sqlite3_errmsg(db);
+	else
+		cerr << sqlite3_errstr(rc);
+	cerr << endl;
+	exit(1);
+}
+
+// Fast inserts (see Sqlite::begin_commands) in a single transaction
+const char *
+SqliteNative::begin_commands()
+{
+	return "PRAGMA synchronous = OFF;\n"
+		"PRAGMA journal_mode = OFF;\n"
+		"PRAGMA locking_mode = EXCLUSIVE;\n"
+		"PRAGMA cache_size = -262144;\n"
+		"BEGIN TRANSACTION;\n";
+}
+
+void
+SqliteNative::execute(ostream &, const string &commands)
+{
+	char *errmsg;
+
+	if (sqlite3_exec(db, commands.c_str(), nullptr, nullptr, &errmsg) != SQLITE_OK) {
+		cerr << path << ": " << errmsg << endl;
+		sqlite3_free(errmsg);
+		exit(1);
+	}
+}
+
+// Return the next value slot of the current row
+SqliteNative::Value &
+SqliteNative::next_value()
+{
+	// Slots are reused across rows to avoid repeated string allocations
+	if (nvalues == row.size())
+		row.emplace_back();
+	return row[nvalues++];
+}
+
+void
+SqliteNative::begin_row(ostream &, const char *t)
+{
+	table = t;
+	nvalues = 0;
+}
+
+void
+SqliteNative::int_value(ostream &, long long v)
+{
+	Value &val = next_value();
+	val.type = Value::v_int;
+	val.i = v;
+}
+
+void
+SqliteNative::real_value(ostream &, double v)
+{
+	Value &val = next_value();
+	val.type = Value::v_real;
+	val.r = v;
+}
+
+void
+SqliteNative::bool_value(ostream &of, bool v)
+{
+	int_value(of, v ? 1 : 0);
+}
+
+void
+SqliteNative::null_value(ostream &)
+{
+	next_value().type = Value::v_null;
+}
+
+/*
+ * Store the string as the textual SQLite back-end would, so that
+ * tools processing the database (e.g. csreconst) work unchanged.
+ * Only line ends need encoding; quotes are stored verbatim.
+ */
+void
+SqliteNative::string_value(ostream &, const string &s)
+{
+	Value &val = next_value();
+	val.type = Value::v_string;
+	val.s.clear();
+	for (char c : s)
+		switch (c) {
+		case '\n': val.s += "\\u0000a"; break;
+		case '\r': val.s += "\\u0000d"; break;
+		default: val.s += c; break;
+		}
+}
+
+void
+SqliteNative::end_row(ostream &)
+{
+	sqlite3_stmt *&stmt = statements[table];
+
+	if (!stmt) {
+		string sql("INSERT INTO " + table + " VALUES(");
+		for (unsigned i = 0; i < nvalues; i++)
+			sql += i ? ",?" : "?";
+		sql += ')';
+		check(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr),
+		    SQLITE_OK, "prepare");
+	}
+	for (unsigned i = 0; i < nvalues; i++) {
+		const Value &v = row[i];
+		int rc = SQLITE_OK;
+		switch (v.type) {
+		case Value::v_int:
+			rc = sqlite3_bind_int64(stmt, i + 1, v.i);
+			break;
+		case Value::v_real:
+			rc = sqlite3_bind_double(stmt, i + 1, v.r);
+			break;
+		case Value::v_null:
+			rc = sqlite3_bind_null(stmt, i + 1);
+			break;
+		case Value::v_string:
+			rc = sqlite3_bind_text(stmt, i + 1, v.s.data(), v.s.length(), SQLITE_STATIC);
+			break;
+		}
+		check(rc, SQLITE_OK, "bind");
+	}
+	check(sqlite3_step(stmt), SQLITE_DONE, table.c_str());
+	sqlite3_reset(stmt);
+}
+#endif
@@ -25,25 +25,141 @@
 #ifndef SQL_
 #define SQL_
 
+#include <charconv>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ * Rows are inserted through the begin_row, *_value, end_row sequence.
+ * By default the rows are formatted into per-table buffers, which are
+ * output as multi-row SQL INSERT statements on the passed stream.
+ * Engines that talk directly to a database override these methods.
+ */
 class Sql {
 	// Instance of current engine
 	static Sql *instance;
+protected:
+	// Formatted rows buffered for a table
+	struct TableRows {
+		string table;		// Table name
+		string data;		// Formatted rows
+		unsigned nrows;		// Number of rows in data
+		TableRows(const char *t) : table(t), nrows(0) {}
+	};
+private:
+	vector <TableRows> tables;		// In the order of their first row
+	map <string, size_t> table_index;	// Position in tables
+	TableRows *current;			// Table of the current row
+	size_t buffered;			// Bytes buffered in all tables
+	bool first_value;			// True before a row's first value
+
+	// Output the separator preceding a row's value
+	void separate() {
+		if (first_value)
+			first_value = false;
+		else
+			current->data += value_separator;
+	}
+protected:
+	char value_separator;		// Separator between a row's values
+	const char *real_format;	// Format of non-integral real values
+	unsigned max_batch_rows;	// Rows output in a batch (0 unlimited)
+	size_t max_buffered;		// Bytes buffered before output
+
+	// Hooks for formatting and outputting the buffered rows
+	virtual void open_row(TableRows &t) {
+		if (t.nrows == 0) {
+			t.data += "INSERT INTO ";
+			t.data += t.table;
+			t.data += " VALUES(";
+		} else
+			t.data += ",\n(";
+	}
+	virtual void close_row(TableRows &t) { t.data += ')'; }
+	virtual const char *nullval() { return "NULL"; }
+	virtual void append_string(string &data, const string &s) {
+		data += '\'';
+		append_escaped(data, s);
+		data += '\'';
+	}
+	virtual void output_rows(ostream &of, const TableRows &t) {
+		of.write(t.data.data(), t.data.length());
+		of << ";\n";
+	}
+	// Characters that escape(char) encodes
+	virtual const char *special_chars() { return "'"; }
 public:
+	Sql() : current(nullptr), buffered(0), first_value(true),
+		value_separator(','), real_format("%g"), max_batch_rows(500),
+		max_buffered(1024 * 1024) {}
 	virtual ~Sql() {}
 	// Set the database to the specified engine
 	// Return true if OK
 	static bool setEngine(string_view dbengine);
 	static Sql *getInterface() { return instance; }
+	// Finish working with the current engine
+	static void release() { delete instance; instance = nullptr; }
 	virtual const char * begin_commands() { return ""; };
 	virtual const char * end_commands() { return ""; };
-	virtual string escape(string s);
+	// Execute (or output) the specified SQL commands
+	virtual void execute(ostream &of, const string &commands) {
+		of << commands;
+	}
+	// Output all buffered rows
+	virtual void flush(ostream &of);
+	// True if key creation should be deferred until the data is loaded
+	virtual bool defer_keys() { return false; }
+	// Return the command to create a deferred primary key
+	virtual string add_primary_key(const string &table, const string &columns);
+	// Append to out the string s escaped for use in an SQL string
+	void append_escaped(string &out, const string &s);
+	string escape(const string &s) {
+		string r;
+		append_escaped(r, s);
+		return r;
+	}
 	virtual const char * escape(char c);
 	virtual const char *ptrtype() {
 		return sizeof(void *) > 4 ? "BIGINT" : "INTEGER";
 	}
 	virtual const char *booltype() { return "BOOLEAN"; }
 	virtual const char *varchar() { return "CHARACTER VARYING"; }
+	// Type for strings that can be many megabytes long
+	virtual const char *longtext() { return varchar(); }
 	virtual const char *boolval(bool v);
+	/*
+	 * Views presenting the compact TOKENBLOCKS and LINEBLOCKS
+	 * tables as the TOKENS and LINEPOS tables.
+	 * Return nullptr if the engine cannot expand JSON arrays.
+	 */
+	virtual const char *tokens_view() { return nullptr; }
+	virtual const char *linepos_view() { return nullptr; }
+
+	// Start inserting a row into the specified table
+	virtual void begin_row(ostream &of, const char *table);
+	virtual void int_value(ostream &, long long v) {
+		char buff[24];
+		separate();
+		current->data.append(buff, to_chars(buff, buff + sizeof(buff), v).ptr);
+	}
+	virtual void real_value(ostream &of, double v);
+	virtual void bool_value(ostream &, bool v) {
+		separate();
+		current->data += boolval(v);
+	}
+	virtual void null_value(ostream &) {
+		separate();
+		current->data += nullval();
+	}
+	// Add a string value; the string is escaped as required
+	virtual void string_value(ostream &, const string &s) {
+		separate();
+		append_string(current->data, s);
+	}
+	// Finish the row started with begin_row
+	virtual void end_row(ostream &of);
 };
 
 class Mysql: public Sql {
@@ -53,10 +169,15 @@ public:
 	};
 	const char *booltype() { return "bool"; }
 	const char *varchar() { return "TEXT"; }
+	const char *longtext() { return "LONGTEXT"; }
 	const char *boolval(bool v);
+	const char *tokens_view();
+	const char *linepos_view();
 };
 
 class Hsqldb: public Sql {
+protected:
+	const char *special_chars() { return "'\n\r"; }
 public:
 	const char *varchar() { return "LONGVARCHAR"; }
 	const char * escape(char c);
@@ -64,13 +185,132 @@ public:
 
 class Postgres: public Sql {
 public:
+	const char *tokens_view();
+	const char *linepos_view();
 };
 
 class Sqlite: public Sql {
+protected:
+	const char *special_chars() { return "'\n\r"; }
 public:
 	const char *begin_commands();
 	const char * escape(char c);
+	string add_primary_key(const string &table, const string &columns);
+	const char *tokens_view();
+	const char *linepos_view();
+};
+
+/*
+ * Output rows in the tab-separated format used by the database's
+ * bulk loading command (COPY or LOAD DATA), rather than as INSERT
+ * statements.
+ * Each output batch contains all rows buffered for a table.
+ */
+template <class Engine>
+class BulkLoad: public Engine {
+protected:
+	typedef typename Engine::TableRows TableRows;
+	void open_row(TableRows &) {}
+	void close_row(TableRows &t) { t.data += '\n'; }
+	const char *nullval() { return "\\N"; }
+	// Backslash-escape the characters that have a special meaning
+	void append_string(string &data, const string &s) {
+		for (char c : s)
+			switch (c) {
+			case '\\': data += "\\\\"; break;
+			case '\t': data += "\\t"; break;
+			case '\n': data += "\\n"; break;
+			case '\r': data += "\\r"; break;
+			default: data += c; break;
+			}
+	}
+public:
+	BulkLoad() {
+		this->value_separator = '\t';
+		this->real_format = "%.17g";
+		this->max_batch_rows = 0;
+		this->max_buffered = 64 * 1024 * 1024;
+	}
+	bool defer_keys() { return true; }
+};
+
+// Output tables for loading through PostgreSQL's COPY command
+class PostgresCopy: public BulkLoad<Postgres> {
+protected:
+	void output_rows(ostream &of, const TableRows &t) {
+		of << "COPY " << t.table << " FROM STDIN;\n";
+		of.write(t.data.data(), t.data.length());
+		of << "\\.\n";
+	}
+};
+
+/*
+ * Output tables into files in the specified directory, for loading
+ * through MySQL's LOAD DATA command.
+ */
+class MysqlLoad: public BulkLoad<Mysql> {
+private:
+	string directory;		// Where table files are written
+	int nfiles;			// Number of files written
+protected:
+	void output_rows(ostream &of, const TableRows &t);
+public:
+	MysqlLoad(const string &d) : directory(d), nfiles(0) {}
+	const char *begin_commands();
+	const char *end_commands() {
+		return "SET unique_checks = 1;\n"
+			"SET foreign_key_checks = 1;\n"
+			"SET SESSION sql_mode=@old_sql_mode;\n";
+	}
+};
+
+#ifdef HAVE_SQLITE
+struct sqlite3;
+struct sqlite3_stmt;
+
+/*
+ * Write directly into an SQLite database file through prepared
+ * statements, rather than outputting SQL text.
+ * All data are inserted in a single transaction, and the primary
+ * keys are created after the data have been loaded.
+ */
+class SqliteNative: public Sqlite {
+private:
+	// A value to bind to the current row's statement
+	struct Value {
+		enum { v_int, v_real, v_null, v_string } type;
+		long long i;
+		double r;
+		string s;
+	};
+	sqlite3 *db;			// Database handle
+	string path;			// Database file
+	// Prepared insert statements keyed by table name
+	map <string, sqlite3_stmt *> statements;
+	string table;			// Table of the current row
+	vector <Value> row;		// Values of the current row
+	unsigned nvalues;		// Number of values in the current row
+	// Return the next value slot of the current row
+	Value &next_value();
+	// Exit with an error message if rc is not the expected code
+	void check(int rc, int expected, const char *context);
+public:
+	SqliteNative(const string &path);
+	~SqliteNative();
+	const char *begin_commands();
+	const char *end_commands() { return "COMMIT;\n"; }
+	void execute(ostream &of, const string &commands);
+	bool defer_keys() { return true; }
+
+	void begin_row(ostream &of, const char *table);
+	void int_value(ostream &of, long long v);
+	void real_value(ostream &of, double v);
+	void bool_value(ostream &of, bool v);
+	void null_value(ostream &of);
+	void string_value(ostream &of, const string &s);
+	void end_row(ostream &of);
 };
+#endif
 
 
 // Return SQL equivalent for the logical value v
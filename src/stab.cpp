@@ -149,6 +149,18 @@ Block::define(Stab Block::*table, const Token& tok, const Type& typ, FCall *fc,
 	(scope_block[current_block].*table).define(tok, typ, fc, go);
 }
 
+// Clear all block-related information
+void
+Block::clear()
+{
+	vectorBlock().swap(scope_block);
+	param_block = Block();
+	current_block = -1;
+	param_block_nesting = -1;
+	param_use = false;
+	param_seen = false;
+}
+
 // Called when exiting a function block statement
 void
 Block::param_clear(void)
@@ -0,0 +1,21 @@
+/*
+ * Functions and calls for the JSON pages, in projects whose names
+ * are encoded in ISO-8859-1 and in UTF-8
+ */
+static int
+leaf(int x)
+{
+	return x + 1;
+}
+
+int
+middle(int x)
+{
+	return leaf(x) * 2;
+}
+
+int
+top(void)
+{
+	return middle(1) + leaf(2);
+}
@@ -0,0 +1,51 @@
+/*
+ * Source page rendering: HTML metacharacters, tabs, macros,
+ * functions, unprocessed lines, and split identifiers
+ */
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define LIMIT	100
+
+struct point {
+	int x, y;	/* <x> & <y> */
+};
+
+static int counter;
+
+/* Identifiers split by line continuations */
+int split_\
+name;
+
+static int
+count(int n)
+{
+	return counter += n;
+}
+
+int
+max_point(struct point *p)
+{
+	const char *s = "a < b && b > c";
+
+	(void)s;
+	split_name = MAX(p->x, p->y);
+	if (split_\
+name > LIMIT)
+		count(1);
+	return MAX(split_name, count(0));
+}
+
+/* A function name split by a line continuation and followed by a tab */
+static int
+split_\
+fun	(void)
+{
+	return count(1);
+}
+
+#if 0
+int
+unused(void)
+{
+	return max_point(0) & 1;
+}
+#endif
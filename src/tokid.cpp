@@ -49,9 +49,12 @@
 #include "macro.h"
 #include "pdtoken.h"
 #include "eclass.h"
+#include "memstat.h"
 
 
 mapTokidEclass Tokid::tm;		// Map from tokens to their equivalence
+vectorTokidEclass Tokid::ftm;		// Frozen form of tm
+bool Tokid::frozen;			// True when ftm is used instead of tm
 
 mapTokidEclass tokid_map;		// Dummy; used for printing
 
@@ -68,16 +71,13 @@ operator<<(ostream& o,const Tokid t)
 ostream&
 operator<<(ostream& o,const mapTokidEclass&)
 {
-	mapTokidEclass::const_iterator i;
-
-	for (i = Tokid::tm.begin(); i != Tokid::tm.end(); i++) {
+	Tokid::for_each_ec([&o](Tokid t, const Eclass *e) {
 		// Convert Tokids into Tparts to also display their content
-		Tokid t = (*i).first;
-		Eclass e = *((*i).second);
-		Tpart p(t, e.get_len());
+		Tpart p(t, e->get_len());
 		o << p << ":\n";
-		o << e << "\n\n";
-	}
+		o << *e << "\n\n";
+		return true;
+	});
 	return o;
 }
 
@@ -91,13 +91,14 @@ Tokid::dump_map()
 void
 Tokid::clear()
 {
-	mapTokidEclass::const_iterator i;
 	set <Eclass *> es;
 
-	if (DP()) cout << "Have " << Tokid::tm.size() << " tokids\n";
+	if (DP()) cout << "Have " << map_size() << " tokids\n";
 	// First create a set of all ecs
-	for (i = Tokid::tm.begin(); i != Tokid::tm.end(); i++)
-		es.insert((*i).second);
+	for_each_ec([&es](Tokid, Eclass *e) {
+		es.insert(e);
+		return true;
+	});
 	// Then free them
 	if (DP()) cout << "Deleting " << es.size() << " classes\n";
 	set <Eclass *>::const_iterator si;
@@ -107,6 +108,26 @@ Tokid::clear()
 	}
 	// Finally, clear the map
 	tm.clear();
+	vectorTokidEclass().swap(ftm);
+	frozen = false;
+}
+
+/*
+ * Move the map's elements into the sorted vector.
+ * They are erased from the map as they are moved, so that the
+ * memory required by the conversion does not exceed by much
+ * the map's original size.
+ */
+void
+Tokid::freeze()
+{
+	if (frozen)
+		return;
+	ftm.reserve(tm.size());
+	for (mapTokidEclass::iterator i = tm.begin(); i != tm.end(); i = tm.erase(i))
+		if (i->second)
+			ftm.push_back(*i);
+	frozen = true;
 }
 
 dequeTpart
@@ -114,9 +135,9 @@ Tokid::constituents(int l)
 {
 	Tokid t = *this;
 	dequeTpart r;
-	mapTokidEclass::const_iterator e = tm.find(t);
+	Eclass *e = t.check_ec();
 
-	if (e == Tokid::tm.end()) {
+	if (e == NULL) {
 		// No EC defined, create a new one
 		new Eclass(t, l);
 		Tpart tp(t, l);
@@ -126,11 +147,11 @@ Tokid::constituents(int l)
 	// Make r be the Tparts of the ECs covering our tokid t
 	for (;;) {
 		if (DP())
-			cout << "Tokid = " << (e->first) << " Eclass = " << e->second << "\n" << (*(e->second)) << "\n";
-		int covered = (e->second)->get_len();
+			cout << "Tokid = " << t << " Eclass = " << e << "\n" << *e << "\n";
+		int covered = e->get_len();
 		if (!Pdtoken::skipping()) {
 			// Add the existing classes to our current project
-			(e->second)->set_attribute(Project::get_current_projid());
+			e->set_attribute(Project::get_current_projid());
 			if (DP())
 				cout << "Set projid to " << Project::get_current_projid() << "\n";
 		}
@@ -143,10 +164,10 @@ Tokid::constituents(int l)
 		if (l == 0)
 			return (r);
 		t += covered;
-		e = tm.find(t);
-		// csassert(e != Tokid::tm.end());
+		e = t.check_ec();
+		// csassert(e != NULL);
 		// Can only happen if we are deleting ECs with -m
-		if (e == Tokid::tm.end()) {
+		if (e == NULL) {
 			// No EC defined, create a new one covering the rest
 			new Eclass(t, l);
 			Tpart tp(t, l);
@@ -161,26 +182,25 @@ void
 Tokid::set_ec_attribute(enum e_attribute a, int l) const
 {
 	Tokid t = *this;
-	dequeTpart r;
-	mapTokidEclass::const_iterator e = tm.find(t);
+	Eclass *e = t.check_ec();
 
-	if (e == Tokid::tm.end()) {
+	if (e == NULL) {
 		// No EC defined, create a new one
-		Eclass *e = new Eclass(t, l);
+		e = new Eclass(t, l);
 		e->set_attribute(a);
 		return;
 	}
 	// Set the ECs covering our tokid t
 	for (;;) {
-		int covered = (e->second)->get_len();
-		(e->second)->set_attribute(a);
+		int covered = e->get_len();
+		e->set_attribute(a);
 		l -= covered;
 		csassert(l >= 0);
 		if (l == 0)
 			return;
 		t += covered;
-		e = tm.find(t);
-		csassert(e != Tokid::tm.end());
+		e = t.check_ec();
+		csassert(e != NULL);
 	}
 }
 
@@ -189,24 +209,23 @@ bool
 Tokid::has_ec_attribute(enum e_attribute a, int l) const
 {
 	Tokid t = *this;
-	dequeTpart r;
-	mapTokidEclass::const_iterator e = tm.find(t);
+	Eclass *e = t.check_ec();
 
-	if (e == Tokid::tm.end())
+	if (e == NULL)
 		// No EC defined, create a new one
 		return false;
 	// Check the ECs covering our tokid t
 	for (;;) {
-		int covered = (e->second)->get_len();
-		if ((e->second)->get_attribute(a))
+		int covered = e->get_len();
+		if (e->get_attribute(a))
 			return true;
 		l -= covered;
 		csassert(l >= 0);
 		if (l == 0)
 			return false;
 		t += covered;
-		e = tm.find(t);
-		csassert(e != Tokid::tm.end());
+		e = t.check_ec();
+		csassert(e != NULL);
 	}
 }
 
@@ -232,6 +251,16 @@ Tokid::unique() const
 	}
 	return Tokid(*(Filedetails::get_identical_files(fi).begin()), offs);
 }
+
+void
+Tokid::memory_stats(MemoryStats &s)
+{
+	if (frozen)
+		s.add("Token to equivalence class map", ftm.size(), vector_bytes(ftm));
+	else
+		s.add("Token to equivalence class map", tm.size(), node_bytes(tm));
+}
+
 #ifdef UNIT_TEST
 // cl -GX -DWIN32 -c eclass.cpp fileid.cpp
 // cl -GX -DWIN32 -DUNIT_TEST tokid.cpp eclass.obj fileid.obj kernel32.lib
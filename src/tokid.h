@@ -39,6 +39,8 @@
 
 #include <deque>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -51,11 +53,13 @@ class Eclass;
 
 class Tokid;
 class Tpart;
+class MemoryStats;
 typedef deque <Tokid> dequeTokid;
 typedef deque <Tpart> dequeTpart;
 
 class Tokid;
 typedef map <Tokid, Eclass *> mapTokidEclass;
+typedef vector <pair <Tokid, Eclass *> > vectorTokidEclass;
 
 class Tokid {
 #ifdef PICO_QL
@@ -66,6 +70,18 @@ private:
 	static mapTokidEclass tm;	// Map from tokens to their equivalence
 					// classes
 private:
+	/*
+	 * Once the processing is over the map is only read.
+	 * It is then converted into a sorted vector, which takes
+	 * less space and is faster to search.  Erased elements
+	 * are kept in the vector with a NULL equivalence class.
+	 */
+	static vectorTokidEclass ftm;	// Frozen form of tm
+	static bool frozen;		// True when ftm is used instead of tm
+	// Return the first ftm element at or after t
+	static inline vectorTokidEclass::iterator ftm_lower_bound(Tokid t);
+	template <typename I, typename F>
+	static void for_each_ec(I begin, I end, F f);
 	Fileid fi;			// File
 	cs_offset_t offs;		// Offset
 public:
@@ -97,18 +113,16 @@ public:
 	// Set its equivalence class to ec (done when adding it to an Eclass)
 	// use Eclass:add_tokid, not this method in all other contexts
 	inline void set_ec(Eclass *ec) const;
-	// Return an iterator to the map for this tokid or the end_ec() value
-	mapTokidEclass::iterator find_ec() const { return tm.find(*this); }
-
-	// The map's begin
-	static mapTokidEclass::iterator begin_ec() { return tm.begin(); }
-
-	// The not-found value
-	static mapTokidEclass::iterator end_ec() { return tm.end(); }
-
+	// Call f(tokid, ec) for all the map's elements in order, while it returns true
+	template <typename F>
+	static void for_each_ec(F f);
+	// Call f(tokid, ec) for the map's elements at or after t in order, while it returns true
+	template <typename F>
+	static void for_each_ec(Tokid t, F f);
 	// Erase the tokid's EC from the map
-	inline void erase_ec(mapTokidEclass::iterator i) const;
 	inline void erase_ec() const;
+	// Convert the map into its compact read-mostly form
+	static void freeze();
 	// Returns the Tokids participating in all ECs for a token of length l
 	dequeTpart constituents(int l);
 	// Set the Tokid's equivalence class attribute
@@ -127,7 +141,9 @@ public:
 	inline const string& get_path() const { return fi.get_path(); }
 	inline Fileid get_fileid() const { return fi; }
 	inline streampos get_streampos() const { return (streampos)offs; }
-	static map <Tokid, Eclass *>::size_type map_size() { return tm.size(); }
+	static size_t map_size() { return frozen ? ftm.size() : tm.size(); }
+	// Add the memory used by the map to s
+	static void memory_stats(MemoryStats &s);
 };
 
 // Print dequeTokid sequences
@@ -197,15 +213,30 @@ operator >=(const class Tokid a, const class Tokid b)
 	return b < a || a == b;
 }
 
+inline vectorTokidEclass::iterator
+Tokid::ftm_lower_bound(Tokid t)
+{
+	return lower_bound(ftm.begin(), ftm.end(), t,
+	    [](const vectorTokidEclass::value_type &a, Tokid b) { return a.first < b; });
+}
+
 inline Eclass *
 Tokid::get_ec() const
 {
+	if (frozen)
+		return check_ec();
 	return tm[*this];
 }
 
 inline Eclass *
 Tokid::check_ec() const
 {
+	if (frozen) {
+		vectorTokidEclass::const_iterator i = ftm_lower_bound(*this);
+		if (i == ftm.end() || i->first != *this)
+			return NULL;
+		return i->second;
+	}
 	mapTokidEclass::const_iterator i = tm.find(*this);
 	if (i == tm.end())
 		return NULL;
@@ -221,6 +252,15 @@ Tokid::set_ec(Eclass *ec) const
 	 * Efficiently implement the functionality we need.
 	 * See Meyers Effective STL, Item 24.
 	 */
+	if (frozen) {
+		// Rare; elements are only added while processing
+		vectorTokidEclass::iterator i = ftm_lower_bound(*this);
+		if (i != ftm.end() && i->first == *this)
+			i->second = ec;
+		else
+			ftm.insert(i, vectorTokidEclass::value_type(*this, ec));
+		return;
+	}
 	mapTokidEclass::iterator i = tm.lower_bound(*this);
 	if (i != tm.end() && i->first == *this)
 		i->second = ec;
@@ -228,17 +268,46 @@ Tokid::set_ec(Eclass *ec) const
 		tm.insert(i, mapTokidEclass::value_type(*this, ec));
 }
 
-inline void
-Tokid::erase_ec(mapTokidEclass::iterator i) const
-{
-	tm.erase(i);
-}
-
 inline void
 Tokid::erase_ec() const
 {
+	if (frozen) {
+		vectorTokidEclass::iterator i = ftm_lower_bound(*this);
+		csassert(i != ftm.end() && i->first == *this);
+		i->second = NULL;
+		return;
+	}
 	mapTokidEclass::iterator i = tm.find(*this);
 	csassert(i != tm.end());
 	tm.erase(i);
 }
+
+template <typename I, typename F>
+void
+Tokid::for_each_ec(I begin, I end, F f)
+{
+	for (I i = begin; i != end; i++)
+		if (i->second && !f(i->first, i->second))
+			return;
+}
+
+template <typename F>
+void
+Tokid::for_each_ec(F f)
+{
+	if (frozen)
+		for_each_ec(ftm.begin(), ftm.end(), f);
+	else
+		for_each_ec(tm.begin(), tm.end(), f);
+}
+
+template <typename F>
+void
+Tokid::for_each_ec(Tokid t, F f)
+{
+	if (frozen)
+		for_each_ec(ftm_lower_bound(t), ftm.end(), f);
+	else
+		for_each_ec(tm.lower_bound(t), tm.end(), f);
+}
 #endif /* TOKID_ */
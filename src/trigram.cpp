@@ -0,0 +1,166 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Regular expression literal extraction for the trigram index
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+
+#include "trigram.h"
+
+vector <uint32_t>
+trigrams(const string &s)
+{
+	vector <uint32_t> r;
+	if (s.length() < 3)
+		return r;
+	r.reserve(s.length() - 2);
+	uint32_t t = 0;
+	for (size_t i = 0; i < s.length(); i++) {
+		t = ((t << 8) | (unsigned char)tolower((unsigned char)s[i])) & 0xffffff;
+		if (i >= 2)
+			r.push_back(t);
+	}
+	sort(r.begin(), r.end());
+	r.erase(unique(r.begin(), r.end()), r.end());
+	return r;
+}
+
+/*
+ * Return the position of the closing bracket of the bracket expression
+ * starting at re[i], or string::npos if there is none.
+ */
+static size_t
+bracket_end(const string &re, size_t i)
+{
+	size_t j = i + 1;
+	if (j < re.length() && re[j] == '^')
+		j++;
+	if (j < re.length() && re[j] == ']')
+		j++;
+	for (; j < re.length(); j++)
+		if (re[j] == ']')
+			return j;
+		else if (re[j] == '[' && j + 1 < re.length() &&
+		    (re[j + 1] == ':' || re[j + 1] == '.' || re[j + 1] == '=')) {
+			// Character class, collating symbol, or equivalence class
+			char delim[] = {re[j + 1], ']', 0};
+			j = re.find(delim, j + 2);
+			if (j == string::npos)
+				return j;
+			j++;
+		}
+	return string::npos;
+}
+
+/*
+ * The scan is conservative: any construct it does not understand
+ * ends the current literal, so that the literals found are always
+ * required, though not all required literals are necessarily found.
+ */
+bool
+re_required_literals(const string &re, vector <string> &lits)
+{
+	string run;		// Current literal
+	auto end_run = [&]() {
+		if (!run.empty())
+			lits.push_back(run);
+		run.clear();
+	};
+
+	for (size_t i = 0; i < re.length(); i++) {
+		char c = re[i];
+		switch (c) {
+		case '|':		// Alternation; no literal is required
+			lits.clear();
+			return false;
+		case '*':		// Optional preceding character
+		case '?':
+			if (!run.empty())
+				run.pop_back();
+			end_run();
+			break;
+		case '{':		// Bounds may allow zero repetitions
+			if (!run.empty())
+				run.pop_back();
+			end_run();
+			if ((i = re.find('}', i)) == string::npos) {
+				lits.clear();
+				return false;
+			}
+			break;
+		case '+':		// The character appears, but may repeat
+		case '.':
+		case '^':
+		case '$':
+			end_run();
+			break;
+		case '[':
+			end_run();
+			if ((i = bracket_end(re, i)) == string::npos) {
+				lits.clear();
+				return false;
+			}
+			break;
+		case '(':		// Skip the (possibly optional) group
+			{
+				end_run();
+				int depth = 1;
+				while (depth && ++i < re.length())
+					switch (re[i]) {
+					case '(': depth++; break;
+					case ')': depth--; break;
+					case '\\': i++; break;
+					case '[':
+						if ((i = bracket_end(re, i)) == string::npos)
+							i = re.length();
+						break;
+					}
+				if (depth) {
+					lits.clear();
+					return false;
+				}
+			}
+			break;
+		case '\\':
+			if (++i == re.length()) {
+				lits.clear();
+				return false;
+			}
+			c = re[i];
+			// Back-references and GNU word operators are not literals
+			if (isalnum((unsigned char)c) || c == '<' || c == '>' ||
+			    c == '`' || c == '\'')
+				end_run();
+			else
+				run += c;
+			break;
+		default:
+			run += c;
+			break;
+		}
+	}
+	end_run();
+	return true;
+}
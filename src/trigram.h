@@ -0,0 +1,114 @@
+/*
+ * (C) Copyright 2026 Diomidis Spinellis
+ *
+ * This file is part of CScout.
+ *
+ * CScout is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * CScout is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with CScout.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * A trigram index over element names, used for selecting the
+ * candidate elements whose names may match a regular expression
+ *
+ */
+
+#ifndef TRIGRAM_
+#define TRIGRAM_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdint>
+
+using namespace std;
+
+/*
+ * Set lits to literal strings that every match of the extended
+ * regular expression re must contain.
+ * Return false if these cannot be determined, e.g. due to alternation.
+ */
+bool re_required_literals(const string &re, vector <string> &lits);
+
+// Return the case-folded trigrams of s in sorted order, without duplicates
+vector <uint32_t> trigrams(const string &s);
+
+template <typename K>
+class TrigramIndex {
+public:
+	// Sorted keys of the candidate elements; null if all are candidates
+	typedef shared_ptr <const vector <K> > Candidates;
+private:
+	vector <K> keys;		// Indexed elements, by ordinal
+	// Ordinals of the elements containing each trigram, in ascending order
+	unordered_map <uint32_t, vector <uint32_t> > postings;
+public:
+	// Add to the index the element key with the specified name
+	void add(K key, const string &name) {
+		uint32_t n = keys.size();
+		keys.push_back(key);
+		for (uint32_t t : trigrams(name))
+			postings[t].push_back(n);
+	}
+
+	// Return the elements whose names may match the extended RE re
+	Candidates candidates(const string &re) const {
+		vector <string> lits;
+		if (keys.empty() || !re_required_literals(re, lits))
+			return nullptr;
+
+		vector <uint32_t> tri;
+		for (const string &l : lits) {
+			vector <uint32_t> t(trigrams(l));
+			tri.insert(tri.end(), t.begin(), t.end());
+		}
+		if (tri.empty())
+			return nullptr;
+
+		// Intersect the postings, starting from the shortest
+		vector <const vector <uint32_t> *> lists;
+		for (uint32_t t : tri) {
+			auto p = postings.find(t);
+			if (p == postings.end())
+				return make_shared<const vector <K> >();
+			lists.push_back(&p->second);
+		}
+		sort(lists.begin(), lists.end(),
+		    [](const vector <uint32_t> *a, const vector <uint32_t> *b) {
+			return a->size() < b->size();
+		});
+		vector <uint32_t> result(*lists[0]), tmp;
+		for (size_t i = 1; i < lists.size() && !result.empty(); i++) {
+			tmp.clear();
+			set_intersection(result.begin(), result.end(),
+			    lists[i]->begin(), lists[i]->end(), back_inserter(tmp));
+			result.swap(tmp);
+		}
+
+		vector <K> r;
+		r.reserve(result.size());
+		for (uint32_t n : result)
+			r.push_back(keys[n]);
+		sort(r.begin(), r.end());
+		r.erase(unique(r.begin(), r.end()), r.end());
+		return make_shared<const vector <K> >(std::move(r));
+	}
+
+	// Return true if the element key is among the candidates c
+	static bool may_match(const Candidates &c, K key) {
+		return !c || binary_search(c->begin(), c->end(), key);
+	}
+};
+
+#endif // TRIGRAM_
@@ -1198,14 +1198,12 @@ Type_node::merge_with(Type t)
 	cerr << "B: " << t << "\n";
 }
 
-#ifdef NODE_USE_PROFILE
 int Type_node::count;
 
 int Type_node::get_count()
 {
 	return count;
 }
-#endif
 
 size_t Tsu::get_sizeof() const {
 	// Approximate C layout by accounting for member alignment/padding.
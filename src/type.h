@@ -93,24 +93,18 @@ class Tsu_unnamed {};
 class Type_node {
 	friend class Type;
 private:
-#ifdef NODE_USE_PROFILE
-	static int count;
-#endif
+	static int count;			// Number of live nodes
 	int use;				// Use count
 	// Do not allow copy and assignment; it has to be performed around Type
 	Type_node(const Type_node &);
 	Type_node& operator=(const Type_node &);
 protected:
 	Type_node() : use(1) {
-#ifdef NODE_USE_PROFILE
 		count++;
-#endif
 	}
 
 	virtual ~Type_node() {
-#ifdef NODE_USE_PROFILE
 		count--;
-#endif
 	}
 	virtual Type subscript() const;		// Arrays and pointers
 	virtual Type deref() const;		// Arrays and pointers
@@ -173,9 +167,7 @@ public:
 	virtual Type merge(Tbasic *b);
 	virtual Tbasic *tobasic();
 	virtual void print(ostream &o) const = 0;
-#ifdef NODE_USE_PROFILE
 	static int get_count();
-#endif
 };
 
 // Used by types with a storage class: Tbasic, Tsu, Tenum, Tincomplete, Tptr, Tarray
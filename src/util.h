@@ -26,8 +26,46 @@
 
 #include <string>
 #include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstddef>
 
 std::vector<std::string> split_by_delimiter(std::string &s, char delim);
 std::string version_info(bool html);
 
+/*
+ * Return the number of parts into which to divide the processing of
+ * n elements, so that each part has at least min_part elements and
+ * there is no more than one part per hardware thread.
+ */
+inline unsigned
+parallel_part_count(size_t n, size_t min_part)
+{
+	size_t parts = std::max(std::thread::hardware_concurrency(), 1u);
+	return (unsigned)std::max<size_t>(std::min(parts, n / min_part), 1);
+}
+
+/*
+ * Divide the range [0, n) into the specified number of consecutive
+ * parts, and call f(part, begin, end) for each one in a separate
+ * thread, returning once all have finished.
+ * A single part is processed in the calling thread.
+ * Combining the parts' results in order gives the same result
+ * as sequential processing.
+ */
+template <typename F>
+void
+parallel_for_parts(unsigned parts, size_t n, F f)
+{
+	if (parts == 1) {
+		f(0u, (size_t)0, n);
+		return;
+	}
+	std::vector<std::thread> threads;
+	for (unsigned p = 0; p < parts; p++)
+		threads.emplace_back(f, p, n * p / parts, n * (p + 1) / parts);
+	for (std::thread &t : threads)
+		t.join();
+}
+
 #endif  /* UTIL_H */
\ No newline at end of file
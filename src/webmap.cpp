@@ -419,12 +419,11 @@ main(int argc, char *argv[])
 			if (e->get_attribute(j))
 				fo << "<li>" << Project::get_projname(j) << "\n";
 		fo << "</ul>\n</ul>\n";
-		typedef set <Fileid, fname_order> IFSet;
-		IFSet ifiles = e->sorted_files();
+		const vector <Fileid> &ifiles = e->sorted_files();
 		(*i).set_xfile(ifiles.size() > 1);
 		fo << "<h2>Dependent Files (Writable)</h2>\n";
 		fo << "<ul>\n";
-		for (IFSet::const_iterator j = ifiles.begin(); j != ifiles.end(); j++) {
+		for (vector <Fileid>::const_iterator j = ifiles.begin(); j != ifiles.end(); j++) {
 			if ((*j).get_readonly() == false) {
 				fo << "\n<li>";
 				html_file(fo, (*j).get_path());
@@ -433,7 +432,7 @@ main(int argc, char *argv[])
 		fo << "</ul>\n";
 		fo << "<h2>Dependent Files (All)</h2>\n";
 		fo << "<ul>\n";
-		for (IFSet::const_iterator j = ifiles.begin(); j != ifiles.end(); j++) {
+		for (vector <Fileid>::const_iterator j = ifiles.begin(); j != ifiles.end(); j++) {
 			fo << "\n<li>";
 			html_file(fo, (*j).get_path());
 		}
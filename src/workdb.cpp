@@ -34,6 +34,7 @@
 #include <set>
 #include <sstream>		// ostringstream
 #include <cstdio>		// perror
+#include <charconv>		// to_chars
 
 #include "cpp.h"
 #include "error.h"
@@ -118,6 +119,16 @@ table_is_enabled(enum e_table t)
 	return !disabled_tables[t];
 }
 
+// True if TOKENS and LINEPOS are stored as per-file delta arrays
+static bool compact_tables;
+
+// Store the TOKENS and LINEPOS tables in compact form
+void
+workdb_set_compact()
+{
+	compact_tables = true;
+}
+
 
 // Our identifiers to store as a set
 class Identifier {
@@ -153,50 +164,58 @@ insert_eclass(Sql *db, ostream &of, Eclass *e, const string &name)
 	// Update metrics
 	id_msum.add_unique_id(e);
 
-	if (table_is_enabled(t_ids))
-		of << "INSERT INTO IDS VALUES(" <<
-		     ptr_offset(e) << ",'" <<
-		     name << "'," <<
-		     db->boolval(e->get_attribute(is_readonly)) << ',' <<
-		     db->boolval(e->get_attribute(is_undefined_macro)) << ',' <<
-		     db->boolval(e->get_attribute(is_undefed_macro)) << ',' <<
-		     db->boolval(e->get_attribute(is_redefined_same_macro)) << ',' <<
-		     db->boolval(e->get_attribute(is_redefined_diff_macro)) << ',' <<
-		     db->boolval(e->get_attribute(is_macro)) << ',' <<
-		     db->boolval(e->get_attribute(is_fun_macro)) << ',' <<
-		     db->boolval(e->get_attribute(is_macro_arg)) << ',' <<
-		     db->boolval(e->get_attribute(is_cpp_const)) << ',' <<
-		     db->boolval(e->get_attribute(is_cpp_str_val)) << ',' <<
-		     db->boolval(e->get_attribute(is_def_c_const)) << ',' <<
-		     db->boolval(e->get_attribute(is_def_not_c_const)) << ',' <<
-		     db->boolval(e->get_attribute(is_exp_c_const)) << ',' <<
-		     db->boolval(e->get_attribute(is_exp_not_c_const)) << ',' <<
-
-		     db->boolval(e->get_attribute(is_ordinary)) << ',' <<
-		     db->boolval(e->get_attribute(is_suetag)) << ',' <<
-		     db->boolval(e->get_attribute(is_sumember)) << ',' <<
-		     db->boolval(e->get_attribute(is_label)) << ',' <<
-		     db->boolval(e->get_attribute(is_typedef)) << ',' <<
-		     db->boolval(e->get_attribute(is_enumeration)) << ',' <<
-		     db->boolval(e->get_attribute(is_yacc)) << ',' <<
-		     db->boolval(e->get_attribute(is_cfunction)) << ',' <<
-		     db->boolval(e->get_attribute(is_cscope)) << ',' <<
-		     db->boolval(e->get_attribute(is_lscope)) << ',' <<
-		     db->boolval(e->is_unused()) <<
-		     ");\n";
+	if (table_is_enabled(t_ids)) {
+		db->begin_row(of, "IDS");
+		db->int_value(of, ptr_offset(e));
+		db->string_value(of, name);
+		static const int attrs[] = {
+			is_readonly,
+			is_undefined_macro,
+			is_undefed_macro,
+			is_redefined_same_macro,
+			is_redefined_diff_macro,
+			is_macro,
+			is_fun_macro,
+			is_macro_arg,
+			is_cpp_const,
+			is_cpp_str_val,
+			is_def_c_const,
+			is_def_not_c_const,
+			is_exp_c_const,
+			is_exp_not_c_const,
+
+			is_ordinary,
+			is_suetag,
+			is_sumember,
+			is_label,
+			is_typedef,
+			is_enumeration,
+			is_yacc,
+			is_cfunction,
+			is_cscope,
+			is_lscope,
+		};
+		for (int a : attrs)
+			db->bool_value(of, e->get_attribute(a));
+		db->bool_value(of, e->is_unused());
+		db->end_row(of);
+	}
 	// The projects each EC belongs to
 	if (table_is_enabled(t_idproj))
 		for (unsigned j = attr_end; j < Attributes::get_num_attributes(); j++)
-			if (e->get_attribute(j))
-				of << "INSERT INTO IDPROJ VALUES("
-				    << ptr_offset(e) << ',' << j << ");\n";
+			if (e->get_attribute(j)) {
+				db->begin_row(of, "IDPROJ");
+				db->int_value(of, ptr_offset(e));
+				db->int_value(of, j);
+				db->end_row(of);
+			}
 }
 
 // Chunk the input into tables
 class Chunker {
 private:
 	fifstream &in;		// Stream we are reading from
-	string table;		// Table we are chunking into
+	const char *table;	// Table we are chunking into
 	Sql *db;		// Database interface
 	ostream &of;		// Stream for writing SQL statements
 	Fileid fid;		// File we are chunking
@@ -210,11 +229,13 @@ public:
 	// Should be called at the point where new input is expected
 	void flush() {
 		if (chunk.length() > 0) {
-			if (enabled)
-				of << "INSERT INTO " << table << " VALUES("
-				    << fid.get_id()
-				    << "," << (unsigned)startpos
-				    << ",'" << chunk << "');\n";
+			if (enabled) {
+				db->begin_row(of, table);
+				db->int_value(of, fid.get_id());
+				db->int_value(of, (unsigned)startpos);
+				db->string_value(of, chunk);
+				db->end_row(of);
+			}
 			chunk.erase();
 		}
 		startpos = in.tellg();
@@ -226,9 +247,9 @@ public:
 	// s can be input already collected
 	void start(const char *t, bool e, const string &s = string("")) {
 		flush();
-		table = string(t);
+		table = t;
 		startpos -= s.length();
-		chunk = db->escape(s);
+		chunk = s;
 		enabled = e;
 	}
 
@@ -236,26 +257,51 @@ public:
 		start(t, e, string(1, c));
 	}
 
+	// The chunk is escaped when it is output
 	inline void add(char c) {
-		chunk += db->escape(c);
+		chunk += c;
 	}
 };
 
 // Write out the projects for which the given line is processed.
 static void
-line_projects_dump(ostream &of, Fileid fid, int line_number)
+line_projects_dump(Sql *db, ostream &of, Fileid fid, int line_number)
 {
 	for (unsigned projid = attr_end; projid < Attributes::get_num_attributes(); projid++)
 		if (Filedetails::get_attribute(fid, projid)
-		    && Filedetails::is_line_processed(fid, line_number, projid))
-			of << "INSERT INTO LINEPROJ VALUES("
-			    << fid.get_id()
-			    << "," << projid
-			    << "," << line_number
-			    << ");\n";
+		    && Filedetails::is_line_processed(fid, line_number, projid)) {
+			db->begin_row(of, "LINEPROJ");
+			db->int_value(of, fid.get_id());
+			db->int_value(of, projid);
+			db->int_value(of, line_number);
+			db->end_row(of);
+		}
 }
 
 
+/*
+ * Accumulate a JSON array of the differences between successive values.
+ * The array can interleave n sequences; each value is then stored as
+ * the difference from the previous value of its own sequence.
+ */
+class DeltaArray {
+private:
+	string json;		// The array's elements
+	vector <long long> prev;// The previously added value of each sequence
+	size_t next;		// Sequence of the next value
+public:
+	DeltaArray(size_t n = 1) : json("["), prev(n, 0), next(0) {}
+	void add(long long v) {
+		char buff[24];
+		if (json.length() > 1)
+			json += ',';
+		json.append(buff, to_chars(buff, buff + sizeof(buff), v - prev[next]).ptr);
+		prev[next] = v;
+		next = (next + 1) % prev.size();
+	}
+	string get() const { return json + ']'; }
+};
+
 // Add the contents of a file to the Tokens, Comments, Strings, and Rest tables
 // As a side-effect insert corresponding identifiers in the database
 // and populate the LineOffset table
@@ -266,6 +312,8 @@ file_dump(Sql *db, ostream &of, Fileid fid)
 	bool at_bol = true;
 	int line_number = 1;
 	enum e_cfile_state cstate = s_normal;	// C file state machine
+	// Compact table contents; tokens interleave offsets and EC keys
+	DeltaArray token_block(2), line_block;
 
 	fifstream in;
 	in.open(fid.get_path().c_str(), ios::binary);
@@ -307,22 +355,30 @@ file_dump(Sql *db, ostream &of, Fileid fid)
 			insert_eclass(db, of, ec, s);
 			Filedetails::get_pre_cpp_metrics(fid).process_identifier(s, ec);
 			chunker.flush();
-			if (table_is_enabled(t_tokens))
-				of << "INSERT INTO TOKENS VALUES("
-				    << fid.get_id() << ","
-				    << (unsigned)ti.get_streampos() << ","
-				    << ptr_offset(ec) << ");\n";
+			if (table_is_enabled(t_tokens) && compact_tables) {
+				token_block.add((unsigned)ti.get_streampos());
+				token_block.add(ptr_offset(ec));
+			} else if (table_is_enabled(t_tokens)) {
+				db->begin_row(of, "TOKENS");
+				db->int_value(of, fid.get_id());
+				db->int_value(of, (unsigned)ti.get_streampos());
+				db->int_value(of, ptr_offset(ec));
+				db->end_row(of);
+			}
 		} else {
 			Filedetails::get_pre_cpp_metrics(fid).process_char(c);
 			if (at_bol) {
+				if (table_is_enabled(t_linepos) && compact_tables)
+					line_block.add((unsigned)bol);
+				else if (table_is_enabled(t_linepos)) {
+					db->begin_row(of, "LINEPOS");
+					db->int_value(of, fid.get_id());
+					db->int_value(of, (unsigned)bol);
+					db->int_value(of, line_number);
+					db->end_row(of);
+				}
 				if (table_is_enabled(t_linepos))
-					of << "INSERT INTO LINEPOS VALUES("
-					    << fid.get_id()
-					    << "," << (unsigned)bol
-					    << "," << line_number
-					    << ");\n";
-				if (table_is_enabled(t_linepos))
-					line_projects_dump(of, fid, line_number);
+					line_projects_dump(db, of, fid, line_number);
 				at_bol = false;
 			}
 			if (c == '\n') {
@@ -404,9 +460,40 @@ file_dump(Sql *db, ostream &of, Fileid fid)
 		}
 	}
 	chunker.flush();
+	if (!compact_tables)
+		return;
+	if (table_is_enabled(t_tokens)) {
+		db->begin_row(of, "TOKENBLOCKS");
+		db->int_value(of, fid.get_id());
+		db->string_value(of, token_block.get());
+		db->end_row(of);
+	}
+	if (table_is_enabled(t_linepos)) {
+		db->begin_row(of, "LINEBLOCKS");
+		db->int_value(of, fid.get_id());
+		db->string_value(of, line_block.get());
+		db->end_row(of);
+	}
 }
 
 
+// Primary keys (table, columns) whose creation is deferred
+static vector <pair <string, string>> deferred_keys;
+
+/*
+ * Return the schema clause defining the specified primary key.
+ * For databases that load faster without keys, record the key
+ * for creating it through workdb_keys, and return an empty clause.
+ */
+static string
+primary_key(Sql *db, const char *table, const char *columns)
+{
+	if (!db->defer_keys())
+		return string("  PRIMARY KEY(") + columns + "),\n";
+	deferred_keys.emplace_back(table, columns);
+	return "";
+}
+
 void
 workdb_schema(Sql *db, ostream &of)
 {
@@ -468,19 +555,34 @@ workdb_schema(Sql *db, ostream &of)
 				    << " INTEGER, -- "
 				    << Metrics::get_name<FileMetrics>(i)
 				    << "\n";
-		of <<
-		    "  PRIMARY KEY(FID, PRECPP),\n"
+		of
+		    << primary_key(db, "FILEMETRICS", "FID, PRECPP") <<
 		    "  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
 		    ");\n";
 }
 
-	if (table_is_enabled(t_tokens)) of <<
+	if (compact_tables && (table_is_enabled(t_tokens) || table_is_enabled(t_linepos))
+	    && (!db->tokens_view() || !db->linepos_view())) {
+		cerr << "The database engine does not support compact tables" << endl;
+		exit(1);
+	}
+
+	if (table_is_enabled(t_tokens) && compact_tables) of <<
+		"\n\n-- Instances of identifier tokens within the source code, one row per file\n"
+		"CREATE TABLE TOKENBLOCKS(\n"
+		"  FID INTEGER PRIMARY KEY, -- File key\n"
+		"  TOKENS " << db->longtext() << ", -- JSON array of offset and identifier key differences\n"
+		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
+		");\n"
+		"\n-- Instances of identifier tokens within the source code\n"
+		<< db->tokens_view();
+	else if (table_is_enabled(t_tokens)) of <<
 		"\n\n-- Instances of identifier tokens within the source code\n"
 		"CREATE TABLE TOKENS(\n"
 		"  FID INTEGER, -- File key\n"
 		"  FOFFSET INTEGER, -- Offset within the file\n"
 		"  EID " << db->ptrtype() << ", -- Identifier key\n"
-		"  PRIMARY KEY(FID, FOFFSET),\n"
+		<< primary_key(db, "TOKENS", "FID, FOFFSET") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID),\n"
 		"  FOREIGN KEY(EID) REFERENCES IDS(EID)\n"
 		");\n";
@@ -491,7 +593,7 @@ workdb_schema(Sql *db, ostream &of)
 		"  FID INTEGER, -- File key\n"
 		"  FOFFSET INTEGER, -- Offset within the file\n"
 		"  COMMENT " << db->varchar() << ", -- The comment, including its delimiters\n"
-		"  PRIMARY KEY(FID, FOFFSET),\n"
+		<< primary_key(db, "COMMENTS", "FID, FOFFSET") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
 		");\n";
 
@@ -501,7 +603,7 @@ workdb_schema(Sql *db, ostream &of)
 		"  FID INTEGER, -- File key\n"
 		"  FOFFSET INTEGER, -- Offset within the file\n"
 		"  STRING " << db->varchar() << ", -- The string, including its delimiters\n"
-		"  PRIMARY KEY(FID, FOFFSET),\n"
+		<< primary_key(db, "STRINGS", "FID, FOFFSET") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
 		");\n";
 
@@ -511,17 +613,26 @@ workdb_schema(Sql *db, ostream &of)
 		"  FID INTEGER, -- File key\n"
 		"  FOFFSET INTEGER, -- Offset within the file\n"
 		"  CODE " << db->varchar() << ", -- The actual code\n"
-		"  PRIMARY KEY(FID, FOFFSET),\n"
+		<< primary_key(db, "REST", "FID, FOFFSET") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
 		");\n";
 
-	if (table_is_enabled(t_linepos)) of <<
+	if (table_is_enabled(t_linepos) && compact_tables) of <<
+		"\n\n-- Line number offsets within each file, one row per file\n"
+		"CREATE TABLE LINEBLOCKS(\n"
+		"  FID INTEGER PRIMARY KEY, -- File key\n"
+		"  FOFFSETS " << db->longtext() << ", -- JSON array of line offset differences\n"
+		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
+		");\n"
+		"\n-- Line number offsets within each file\n"
+		<< db->linepos_view();
+	else if (table_is_enabled(t_linepos)) of <<
 		"\n\n-- Line number offsets within each file\n"
 		"CREATE TABLE LINEPOS(\n"
 		"  FID INTEGER, -- File key\n"
 		"  FOFFSET INTEGER, -- Offset within the file\n"
 		"  LNUM INTEGER, -- Line number (starts at 1)\n"
-		"  PRIMARY KEY(FID, FOFFSET),\n"
+		<< primary_key(db, "LINEPOS", "FID, FOFFSET") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
 		");\n";
 
@@ -538,7 +649,7 @@ workdb_schema(Sql *db, ostream &of)
 		"CREATE TABLE IDPROJ(\n"
 		"  EID " << db->ptrtype() << ", -- Identifier key\n"
 		"  PID INTEGER, -- Project key\n"
-		"  PRIMARY KEY(EID, PID),\n"
+		<< primary_key(db, "IDPROJ", "EID, PID") <<
 		"  FOREIGN KEY(EID) REFERENCES IDS(EID),\n"
 		"  FOREIGN KEY(PID) REFERENCES PROJECTS(PID)\n"
 		");\n";
@@ -548,7 +659,7 @@ workdb_schema(Sql *db, ostream &of)
 		"CREATE TABLE FILEPROJ(\n"
 		"  FID INTEGER, -- File key\n"
 		"  PID INTEGER, -- Project key\n"
-		"  PRIMARY KEY(PID, FID),\n"
+		<< primary_key(db, "FILEPROJ", "PID, FID") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID),\n"
 		"  FOREIGN KEY(PID) REFERENCES PROJECTS(PID)\n"
 		");\n";
@@ -559,7 +670,7 @@ workdb_schema(Sql *db, ostream &of)
 		"  FID INTEGER, -- File key\n"
 		"  PID INTEGER, -- Project key\n"
 		"  LNUM INTEGER, -- Line number (starts at 1)\n"
-		"  PRIMARY KEY(PID, FID, LNUM),\n"
+		<< primary_key(db, "LINEPROJ", "PID, FID, LNUM") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID),\n"
 		"  FOREIGN KEY(PID) REFERENCES PROJECTS(PID)\n"
 		");\n";
@@ -668,8 +779,8 @@ workdb_schema(Sql *db, ostream &of)
 				    << ", -- "
 				    << Metrics::get_name<FunMetrics>(i)
 				    << "\n";
-		of <<
-		    "  PRIMARY KEY(FUNCTIONID, PRECPP),\n"
+		of
+		    << primary_key(db, "FUNCTIONMETRICS", "FUNCTIONID, PRECPP") <<
 		    "  FOREIGN KEY(FUNCTIONID) REFERENCES FUNCTIONS(ID)\n"
 		    ");\n";
 	}
@@ -682,7 +793,7 @@ workdb_schema(Sql *db, ostream &of)
 		"  FID INTEGER, -- File key of the identifier\n"
 		"  FOFFSET INTEGER, -- Offset of the identifier within the file\n"
 		"  LEN INTEGER, -- Length of the identifier part\n"
-		"  PRIMARY KEY(FUNCTIONID, ORDINAL),\n"
+		<< primary_key(db, "FUNCTIONID", "FUNCTIONID, ORDINAL") <<
 		"  FOREIGN KEY(FUNCTIONID) REFERENCES FUNCTIONS(ID),\n"
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
 		");\n";
@@ -701,7 +812,7 @@ workdb_schema(Sql *db, ostream &of)
 		"CREATE TABLE FILECOPIES(\n"
 		"  GROUPID INTEGER, -- File group identifier\n"
 		"  FID INTEGER, -- Key of file belonging to a group of identical files\n"
-		"  PRIMARY KEY(GROUPID, FID),\n"
+		<< primary_key(db, "FILECOPIES", "GROUPID, FID") <<
 		"  FOREIGN KEY(FID) REFERENCES FILES(FID)\n"
 		");\n";
 }
@@ -713,9 +824,12 @@ workdb_rest(Sql *db, ostream &of)
 	const Project::proj_map_type &m = Project::get_project_map();
 	Project::proj_map_type::const_iterator pm;
 	if (table_is_enabled(t_projects))
-		for (pm = m.begin(); pm != m.end(); pm++)
-			of << "INSERT INTO PROJECTS VALUES("
-				<< pm->second << ",'" << pm->first << "');\n";
+		for (pm = m.begin(); pm != m.end(); pm++) {
+			db->begin_row(of, "PROJECTS");
+			db->int_value(of, pm->second);
+			db->string_value(of, pm->first);
+			db->end_row(of);
+		}
 
 	vector <Fileid> files = Fileid::files(true);
 
@@ -725,56 +839,69 @@ workdb_rest(Sql *db, ostream &of)
 	// As a side effect populate the EC identifier member
 	for (vector <Fileid>::iterator i = files.begin(); i != files.end(); i++) {
 		if (table_is_enabled(t_files)) {
-			of << "INSERT INTO FILES VALUES("
-			    << i->get_id() << ",'"
-			    << i->get_path() << "',"
-			    << db->boolval(i->get_readonly());
-			of << ");\n";
+			db->begin_row(of, "FILES");
+			db->int_value(of, i->get_id());
+			db->string_value(of, i->get_path());
+			db->bool_value(of, i->get_readonly());
+			db->end_row(of);
 			// Pre-cpp
-			of << "INSERT INTO FILEMETRICS VALUES("
-			    << i->get_id() << ","
-			    << db->boolval(true);
+			db->begin_row(of, "FILEMETRICS");
+			db->int_value(of, i->get_id());
+			db->bool_value(of, true);
 			for (int j = 0; j < FileMetrics::metric_max; j++) {
 				if (Metrics::is_internal<FileMetrics>(j))
 					continue;
 				if (Metrics::is_pre_cpp<FileMetrics>(j))
-					of << ',' << Filedetails::get_pre_cpp_metrics(*i).get_metric(j);
+					db->real_value(of, Filedetails::get_pre_cpp_metrics(*i).get_metric(j));
 				else
-					of << ",NULL";
+					db->null_value(of);
 			}
-			of << ");\n";
+			db->end_row(of);
 			// Post-cpp
-			of << "INSERT INTO FILEMETRICS VALUES("
-			    << i->get_id() << ","
-			    << db->boolval(false);
+			db->begin_row(of, "FILEMETRICS");
+			db->int_value(of, i->get_id());
+			db->bool_value(of, false);
 			for (int j = 0; j < FileMetrics::metric_max; j++) {
 				if (Metrics::is_internal<FileMetrics>(j))
 					continue;
 				if (Metrics::is_post_cpp<FileMetrics>(j))
-					of << ',' << Filedetails::get_post_cpp_metrics(*i).get_metric(j);
+					db->real_value(of, Filedetails::get_post_cpp_metrics(*i).get_metric(j));
 				else
-					of << ",NULL";
+					db->null_value(of);
 			}
-			of << ");\n";
+			db->end_row(of);
 		}
 		// This invalidates the file's metrics
 		file_dump(db, of, *i);
 		// The projects this file belongs to
 		for (unsigned j = attr_end; j < Attributes::get_num_attributes(); j++)
-			if (Filedetails::get_attribute(*i, j) && table_is_enabled(t_fileproj))
-				of << "INSERT INTO FILEPROJ VALUES("
-				     << i->get_id() << ',' << j << ");\n";
+			if (Filedetails::get_attribute(*i, j) && table_is_enabled(t_fileproj)) {
+				db->begin_row(of, "FILEPROJ");
+				db->int_value(of, i->get_id());
+				db->int_value(of, j);
+				db->end_row(of);
+			}
 
 		// Copies of the file
 		const set <Fileid> &copies(Filedetails::get_identical_files(*i));
 		if (copies.size() > 1
 		    && table_is_enabled(t_filecopies)
 		    && copies.begin()->get_id() == i->get_id()) {
-			for (set <Fileid>::const_iterator j = copies.begin(); j != copies.end(); j++)
-				of << "INSERT INTO FILECOPIES VALUES("
-				     << groupnum << ',' << j->get_id()
-				     << ");\n";
+			for (set <Fileid>::const_iterator j = copies.begin(); j != copies.end(); j++) {
+				db->begin_row(of, "FILECOPIES");
+				db->int_value(of, groupnum);
+				db->int_value(of, j->get_id());
+				db->end_row(of);
+			}
 			groupnum++;
 		}
 	}
 }
+
+// Output the commands creating the keys deferred by workdb_schema
+void
+workdb_keys(Sql *db, ostream &of)
+{
+	for (const auto &k : deferred_keys)
+		of << db->add_primary_key(k.first, k.second);
+}
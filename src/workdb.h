@@ -63,10 +63,16 @@ void table_enable(const char *name);
 // Return true if the specified table is enabled
 bool table_is_enabled(enum e_table t);
 
+// Store the TOKENS and LINEPOS tables in compact form
+void workdb_set_compact();
+
 // Output the database schema
 void workdb_schema(Sql *db, ostream &of);
 
 // Output database data
 void workdb_rest(Sql *db, ostream &of);
 
+// Output the commands creating the keys deferred by workdb_schema
+void workdb_keys(Sql *db, ostream &of);
+
 #endif // WORKDB_